@@ -1,7 +1,10 @@
 #include <benchmark/benchmark.h>
 #include <luabind/bind.hpp>
+#include <luabind/numeric_array.hpp>
 
 #include <iostream>
+#include <span>
+#include <vector>
 
 int errorHandler(lua_State* L) {
     luaL_traceback(L, L, lua_tostring(L, -1), 0);
@@ -21,6 +24,49 @@ public:
         t->x = 0;
     }
 
+    void objectArguments(const Test* a, const Test& b, Test* c) {
+        x = a->x + b.x + c->x;
+    }
+
+    void sharedArgument(std::shared_ptr<Test> other) {
+        x = other->x;
+    }
+
+    void memberFunction() {
+        x = 0;
+    }
+
+    int x;
+};
+
+struct RefCountedTest : luabind::RefCounted {
+public:
+    void refArgument(luabind::ref_ptr<RefCountedTest> other) {
+        x = other->x;
+    }
+
+    int x = 0;
+};
+
+struct ArrayTest : luabind::Object {
+public:
+    double get(size_t idx) const {
+        return values[idx - 1];
+    }
+
+    void set(size_t idx, double value) {
+        values[idx - 1] = value;
+    }
+
+    std::span<double> view() {
+        return values;
+    }
+
+    std::vector<double> values = std::vector<double>(10000);
+};
+
+struct MethodTableTest : luabind::Object {
+public:
     void memberFunction() {
         x = 0;
     }
@@ -46,11 +92,32 @@ protected:
             .class_function("luaFunction", &Test::luaFunction)
             .class_function("classFunction", &Test::classFunction)
             .function("memberFunction", &Test::memberFunction)
+            .function<&Test::memberFunction>("staticMemberFunction")
+            .function("objectArguments", &Test::objectArguments)
+            .function("uncheckedObjectArguments", &Test::objectArguments, luabind::unchecked)
+            .construct_shared<>("create")
+            .function("sharedArgument", &Test::sharedArgument)
+            .function("integral", [](Test* t, int v) { t->x = v; })
+            .function("nothrowIntegral", [](Test* t, int v) noexcept { t->x = v; })
             .function("statelessLambda", [](Test* t) { t->x = 0; })
             .function("lambda", [x](Test* t) {
                 (void)x;
                 t->x = 0;
-            });
+            })
+            .property("x", &Test::x);
+
+        luabind::class_<RefCountedTest>(L, "RefCountedTest")
+            .construct_intrusive<>("create")
+            .function("refArgument", &RefCountedTest::refArgument);
+
+        luabind::class_<ArrayTest>(L, "ArrayTest")
+            .array_range_access(&ArrayTest::get, &ArrayTest::set)
+            .function("view", &ArrayTest::view);
+
+        luabind::numeric_array<double>::bind(L, "DoubleArray");
+
+        luabind::class_<MethodTableTest>(L, "MethodTableTest", luabind::binding_mode::method_table)
+            .function("memberFunction", &MethodTableTest::memberFunction);
 
         luabind::function(L, "globLuaFunction", &globalLuaFunction);
     }
@@ -119,6 +186,32 @@ BENCHMARK_F(BenchmarkBase, MemberFunction)(benchmark::State& state) {
     lua_pop(L, 1);
 }
 
+BENCHMARK_F(BenchmarkBase, StaticMemberFunction)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = Test:new(); for i = 1,1000 do t:staticMemberFunction() end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, MemberFunctionFromMethodTable)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = MethodTableTest:new(); for i = 1,1000 do t:memberFunction() end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
 BENCHMARK_F(BenchmarkBase, StatelessLambdaAsMember)(benchmark::State& state) {
     int r = luaL_loadstring(L, "t = Test:new(); for i = 1,1000 do t:statelessLambda() end");
     if (r != LUA_OK) {
@@ -145,8 +238,210 @@ BENCHMARK_F(BenchmarkBase, LambdaAsMember)(benchmark::State& state) {
     lua_pop(L, 1);
 }
 
-#if 1
+BENCHMARK_F(BenchmarkBase, PropertyRead)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = Test:new(); t.x = 0; local s = 0; for i = 1,1000 do s = s + t.x end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, PropertyWrite)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = Test:new(); for i = 1,1000 do t.x = i end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, ObjectArguments)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = Test:new(); for i = 1,1000 do t:objectArguments(t, t, t) end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, UncheckedObjectArguments)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = Test:new(); for i = 1,1000 do t:uncheckedObjectArguments(t, t, t) end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, SharedPtrArgument)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = Test:create(); for i = 1,1000 do t:sharedArgument(t) end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, RefPtrArgument)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = RefCountedTest:create(); for i = 1,1000 do t:refArgument(t) end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, ArrayElementRead)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "a = ArrayTest:new(); local s = 0; for i = 1,10000 do s = s + a[i] end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, ArrayRangeRead)(benchmark::State& state) {
+    int r = luaL_loadstring(
+        L, "a = ArrayTest:new(); local s = 0; local t = a:getRange(1, 10001); for i = 1,10000 do s = s + t[i] end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, ArraySpanRead)(benchmark::State& state) {
+    int r = luaL_loadstring(
+        L, "a = ArrayTest:new(); local s = 0; local v = a:view(); for i = 1,10000 do s = s + v[i] end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, LuaTableScaleSum)(benchmark::State& state) {
+    int r = luaL_loadstring(L, R"--(
+        t = t or {}
+        for i = 1,10000 do t[i] = i end
+        local s = 0
+        for i = 1,10000 do t[i] = t[i] * 2; s = s + t[i] end
+    )--");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
 
+BENCHMARK_F(BenchmarkBase, NumericArrayScaleSum)(benchmark::State& state) {
+    int r = luaL_loadstring(L, R"--(
+        a = a or DoubleArray:new(10000)
+        a:fillRange(1, 10001, 1)
+        a:scale(2)
+        local s = a:sum()
+    )--");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, ArgumentError)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = Test:new(); for i = 1,1000 do pcall(t.integral, t, 'x') end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, NothrowArgumentError)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "t = Test:new(); for i = 1,1000 do pcall(t.nothrowIntegral, t, 'x') end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, ObjectCreation)(benchmark::State& state) {
+    int r = luaL_loadstring(L, "for i = 1,1000 do local t = Test:new() end");
+    if (r != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(BenchmarkBase, PointerPush)(benchmark::State& state) {
+    Test t;
+    for (auto _ : state) {
+        luabind::value_mirror<Test*>::to_lua(L, &t);
+        lua_pop(L, 1);
+    }
+    lua_gc(L, LUA_GCCOLLECT);
+}
+
+#if 1
 BENCHMARK_MAIN();
 
 #else
@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+#include <luabind/bind.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Container mirrors compared with the conversion loops usually written by hand with lua API.
+
+namespace {
+
+constexpr int vectorSize = 1000;
+constexpr int mapSize = 100;
+constexpr int entitiesCount = 100000;
+
+struct Entity : luabind::Object {
+    int id = 0;
+};
+
+class ContainerBenchmark : public benchmark::Fixture {
+protected:
+    void SetUp(benchmark::State&) override {
+        L = luaL_newstate();
+        luabind::class_<Entity>(L, "Entity").property("id", &Entity::id);
+        for (int i = 0; i < vectorSize; ++i) {
+            vector.push_back(i);
+        }
+        for (int i = 0; i < mapSize; ++i) {
+            map.emplace("key" + std::to_string(i), i);
+        }
+    }
+
+    void TearDown(benchmark::State&) override {
+        lua_close(L);
+        L = nullptr;
+        vector.clear();
+        map.clear();
+    }
+
+    // Scripts usually touch a few elements of the large containers.
+    void touchEntities() {
+        for (lua_Integer i : {1, entitiesCount / 2, entitiesCount}) {
+            lua_geti(L, -1, i);
+            benchmark::DoNotOptimize(lua_touserdata(L, -1));
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 1);
+    }
+
+protected:
+    lua_State* L = nullptr;
+    std::vector<int> vector;
+    std::map<std::string, int> map;
+    std::vector<Entity> entities = std::vector<Entity>(entitiesCount);
+};
+
+BENCHMARK_F(ContainerBenchmark, VectorToLuaMirror)(benchmark::State& state) {
+    for (auto _ : state) {
+        luabind::value_mirror<std::vector<int>>::to_lua(L, vector);
+        lua_pop(L, 1);
+    }
+}
+
+BENCHMARK_F(ContainerBenchmark, VectorToLuaHandwritten)(benchmark::State& state) {
+    for (auto _ : state) {
+        lua_newtable(L);
+        for (size_t i = 0; i < vector.size(); ++i) {
+            lua_pushinteger(L, vector[i]);
+            lua_seti(L, -2, static_cast<lua_Integer>(i + 1));
+        }
+        lua_pop(L, 1);
+    }
+}
+
+BENCHMARK_F(ContainerBenchmark, VectorFromLuaMirror)(benchmark::State& state) {
+    luabind::value_mirror<std::vector<int>>::to_lua(L, vector);
+    for (auto _ : state) {
+        auto v = luabind::value_mirror<std::vector<int>>::from_lua(L, -1);
+        benchmark::DoNotOptimize(v.data());
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(ContainerBenchmark, VectorFromLuaHandwritten)(benchmark::State& state) {
+    luabind::value_mirror<std::vector<int>>::to_lua(L, vector);
+    for (auto _ : state) {
+        std::vector<int> v;
+        const lua_Integer size = luaL_len(L, -1);
+        for (lua_Integer i = 1; i <= size; ++i) {
+            lua_geti(L, -1, i);
+            v.push_back(static_cast<int>(lua_tointeger(L, -1)));
+            lua_pop(L, 1);
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_F(ContainerBenchmark, MapToLuaMirror)(benchmark::State& state) {
+    for (auto _ : state) {
+        luabind::value_mirror<std::map<std::string, int>>::to_lua(L, map);
+        lua_pop(L, 1);
+    }
+}
+
+BENCHMARK_F(ContainerBenchmark, MapToLuaHandwritten)(benchmark::State& state) {
+    for (auto _ : state) {
+        lua_newtable(L);
+        for (const auto& [key, value] : map) {
+            lua_pushinteger(L, value);
+            lua_setfield(L, -2, key.c_str());
+        }
+        lua_pop(L, 1);
+    }
+}
+
+BENCHMARK_F(ContainerBenchmark, EntitiesTable)(benchmark::State& state) {
+    for (auto _ : state) {
+        luabind::value_mirror<std::vector<Entity>>::to_lua(L, entities);
+        touchEntities();
+    }
+}
+
+BENCHMARK_F(ContainerBenchmark, EntitiesProxy)(benchmark::State& state) {
+    for (auto _ : state) {
+        luabind::value_mirror<luabind::container_proxy<std::vector<Entity>>>::to_lua(L, entities);
+        touchEntities();
+    }
+}
+
+} // namespace
+
+BENCHMARK_MAIN();
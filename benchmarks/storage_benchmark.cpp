@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include <luabind/bind.hpp>
+
+#include <string>
+#include <vector>
+
+// Cost of fetching a bound closure by index, as done by __index/__newindex on every member lookup.
+
+namespace {
+
+constexpr int functionsCount = 100;
+
+int dummyFunction(lua_State*) {
+    return 0;
+}
+
+struct Bound : luabind::Object {
+    void f() {}
+};
+
+class StorageBenchmark : public benchmark::Fixture {
+protected:
+    void SetUp(benchmark::State&) override {
+        L = luaL_newstate();
+    }
+
+    void TearDown(benchmark::State&) override {
+        lua_close(L);
+    }
+
+    lua_State* L = nullptr;
+};
+
+} // namespace
+
+// Closures on the stack of a separate thread, moved to the calling state.
+BENCHMARK_F(StorageBenchmark, ThreadStack)(benchmark::State& st) {
+    lua_State* storage = lua_newthread(L);
+    lua_checkstack(storage, functionsCount);
+    for (int i = 0; i < functionsCount; ++i) {
+        lua_pushcfunction(storage, dummyFunction);
+    }
+    int idx = 0;
+    for (auto _ : st) {
+        lua_pushvalue(storage, idx + 1);
+        lua_xmove(storage, L, 1);
+        lua_pop(L, 1);
+        idx = (idx + 1) % functionsCount;
+    }
+}
+
+// Closures in the array part of a table, which is on the stack of the calling state (upvalue of the dispatcher).
+BENCHMARK_F(StorageBenchmark, TableArray)(benchmark::State& st) {
+    lua_createtable(L, functionsCount, 0);
+    const int store = lua_gettop(L);
+    for (int i = 0; i < functionsCount; ++i) {
+        lua_pushcfunction(L, dummyFunction);
+        lua_rawseti(L, store, i + 1);
+    }
+    int idx = 0;
+    for (auto _ : st) {
+        lua_rawgeti(L, store, idx + 1);
+        lua_pop(L, 1);
+        idx = (idx + 1) % functionsCount;
+    }
+}
+
+// Full member lookup through __index, closures are fetched from the function store.
+BENCHMARK_F(StorageBenchmark, MemberLookup)(benchmark::State& st) {
+    std::vector<std::string> names;
+    luabind::class_<Bound> cls(L, "Bound");
+    for (int i = 0; i < functionsCount; ++i) {
+        names.push_back(std::to_string(i).insert(0, 1, 'f'));
+        cls.function(names.back(), &Bound::f);
+    }
+    luaL_dostring(L, "obj = Bound:new()");
+    lua_getglobal(L, "obj");
+    const int obj = lua_gettop(L);
+    int idx = 0;
+    for (auto _ : st) {
+        lua_getfield(L, obj, names[idx].c_str());
+        lua_pop(L, 1);
+        idx = (idx + 1) % functionsCount;
+    }
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include <luabind/bind.hpp>
+
+#include <iostream>
+#include <string>
+#include <utility>
+
+// Synthetic binding with many methods of distinct callable types, but the same signature.
+// Every method is called in turn to measure dispatch with a large number of call thunks.
+
+namespace {
+
+constexpr size_t methodsCount = 1000;
+
+struct Wide : luabind::Object {
+    int x = 0;
+};
+
+template <size_t I>
+void bindMethod(luabind::class_<Wide>& cls) {
+    const int offset = static_cast<int>(I);
+    cls.function(std::to_string(I).insert(0, 1, 'm'), [offset](Wide* self, int v) { self->x = v + offset; });
+}
+
+template <size_t... I>
+void bindMethods(luabind::class_<Wide>& cls, std::index_sequence<I...>) {
+    (bindMethod<I>(cls), ...);
+}
+
+int errorHandler(lua_State* L) {
+    std::cerr << "Error while running script: " << lua_tostring(L, -1) << std::endl;
+    std::abort();
+    return 1;
+}
+
+class ThunkBenchmark : public benchmark::Fixture {
+protected:
+    void SetUp(benchmark::State&) override {
+        L = luaL_newstate();
+        luaL_openlibs(L);
+        lua_pushcfunction(L, errorHandler);
+        errorHandlerIdx = lua_gettop(L);
+
+        luabind::class_<Wide> cls(L, "Wide");
+        bindMethods(cls, std::make_index_sequence<methodsCount> {});
+    }
+
+    void TearDown(benchmark::State&) override {
+        lua_close(L);
+    }
+
+    lua_State* L = nullptr;
+    int errorHandlerIdx = 0;
+};
+
+} // namespace
+
+BENCHMARK_F(ThunkBenchmark, ManyMethods)(benchmark::State& state) {
+    int r = luaL_loadstring(L, R"--(
+        local t = Wide:new()
+        local methods = {}
+        for i = 0, 999 do
+            methods[i + 1] = t["m" .. i]
+        end
+        return function()
+            for i = 1, 1000 do
+                methods[i](t, i)
+            end
+        end
+    )--");
+    if (r != LUA_OK || lua_pcall(L, 0, 1, errorHandlerIdx) != LUA_OK) {
+        std::cout << "Error while loading script: " << lua_tostring(L, -1) << std::endl;
+        return;
+    }
+    for (auto _ : state) {
+        lua_pushvalue(L, -1);
+        lua_pcall(L, 0, 0, errorHandlerIdx);
+    }
+    lua_pop(L, 1);
+}
+
+BENCHMARK_MAIN();
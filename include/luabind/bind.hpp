@@ -2,24 +2,32 @@
 #define LUABIND_BIND_HPP
 
 #include "object.hpp"
+#include "container_proxy.hpp"
 #include "exception.hpp"
 #include "mirror.hpp"
+#include "span.hpp"
 #include "type_storage.hpp"
 #include "wrapper.hpp"
 
+#include <algorithm>
+#include <initializer_list>
+#include <string_view>
 #include <type_traits>
 
 namespace luabind {
 
 template <typename Type, typename... Bases>
 class class_ {
-    static_assert(std::is_base_of_v<Object, Type>,
-                  "Type should be descendant from luabind::Object to ensure correct pointer transformations.");
+    static_assert(std::is_base_of_v<Object, Type> || (ValueType<Type> && sizeof...(Bases) == 0),
+                  "Type should be descendant from luabind::Object to ensure correct pointer transformations, "
+                  "or a final, non-polymorphic type without bases.");
 
 public:
-    class_(lua_State* L, const std::string_view name)
+    class_(lua_State* L, const std::string_view name, binding_mode mode = binding_mode::index_function)
         : _L(L) {
-        _info = type_storage::add_type_info<Type, Bases...>(L, std::string {name}, index_impl, new_index_impl);
+        _info = type_storage::add_type_info<Type, Bases...>(L, std::string {name}, mode);
+        _info->index_function = &index_;
+        _info->new_index_function = &new_index;
         _info->get_metatable(L);
         int mt_idx = lua_gettop(L);
 
@@ -27,17 +35,29 @@ public:
             constructor<>("new");
         }
 
-        // one __index to rule them all and in lua bind them
-        lua_pushliteral(L, "__index");
-        functor_to_lua(L, index_);
-        lua_rawset(L, mt_idx);
-
-        lua_pushliteral(L, "__newindex");
-        functor_to_lua(L, new_index);
-        lua_rawset(L, mt_idx);
+        if (_info->mode == binding_mode::method_table) {
+            // lua looks up methods in the table itself, without calling C function
+            lua_pushliteral(L, "__index");
+            _info->get_method_table(L);
+            lua_rawset(L, mt_idx);
+            lua_pushliteral(L, "__newindex");
+            functor_to_lua(L, method_table_new_index);
+            lua_rawset(L, mt_idx);
+        } else {
+            // one __index to rule them all and in lua bind them
+            _info->set_index_functions(L);
+        }
 
-        user_data::add_destructing_functions(L, mt_idx);
+        if constexpr (ValueType<Type> && std::is_trivially_destructible_v<Type>) {
+            // objects without __gc are not put on the finalization list of lua GC
+            _info->finalized = false;
+        } else {
+            user_data::add_destructing_functions(L, mt_idx);
+        }
         function("delete", &user_data::destruct);
+        // the name is reserved, so it is set directly instead of by class_function
+        lua_pushcfunction(L, &is_instance);
+        lua_setfield(L, mt_idx, is_instance_name);
         lua_pop(L, 1); // pop metatable
     }
 
@@ -53,8 +73,17 @@ public:
         return constructor(name, &shared_ctor_wrapper<Type, Args...>::safe_invoke);
     }
 
+    // Constructs the object owned by its intrusive reference count, the type should be derived from RefCounted.
+    template <typename... Args>
+    class_& construct_intrusive(const std::string_view name) {
+        static_assert(std::is_base_of_v<RefCounted, Type>, "class should be derived from luabind::RefCounted");
+        static_assert(std::is_constructible_v<Type, Args...>, "class should be constructible with given arguments");
+        return constructor(name, &intrusive_ctor_wrapper<Type, Args...>::safe_invoke);
+    }
+
     template <typename Functor>
     class_& constructor(const std::string_view name, Functor&& func) {
+        check_class_function_name(name);
         _info->get_metatable(_L);
         value_mirror<std::string_view>::to_lua(_L, name);
         class_functor_to_lua(_L, std::forward<Functor>(func));
@@ -65,19 +94,75 @@ public:
 
     template <typename Func>
     class_& class_function(const std::string_view name, Func&& func) {
-        _info->get_metatable(_L);
-        value_mirror<std::string_view>::to_lua(_L, name);
-        class_functor_to_lua(_L, std::forward<Func>(func));
-        lua_rawset(_L, -3);
-        lua_pop(_L, 1); // pop metatable
-        return *this;
+        return add_class_function<checked_call_v<false>>(name, std::forward<Func>(func));
+    }
+
+    // Binds class function called without argument checks, see LUABIND_CHECK_LEVEL.
+    template <typename Func>
+    class_& class_function(const std::string_view name, Func&& func, unchecked_t) {
+        return add_class_function<checked_call_v<true>>(name, std::forward<Func>(func));
+    }
+
+    // Binds class function given as template argument, e.g. class_function<&T::create>("create").
+    template <auto Func>
+    class_& class_function(const std::string_view name) {
+        return add_static_class_function<Func, checked_call_v<false>>(name);
+    }
+
+    template <auto Func>
+    class_& class_function(const std::string_view name, unchecked_t) {
+        return add_static_class_function<Func, checked_call_v<true>>(name);
     }
 
 public:
     template <ValidMemberFunctor<Type> Func>
     class_& function(const std::string_view name, Func&& func) {
-        functor_to_lua(_L, std::forward<Func>(func));
-        _info->set_function(_L, std::string {name});
+        return add_function<checked_call_v<false>>(name, std::forward<Func>(func));
+    }
+
+    // Binds member function called without argument checks, see LUABIND_CHECK_LEVEL.
+    template <ValidMemberFunctor<Type> Func>
+    class_& function(const std::string_view name, Func&& func, unchecked_t) {
+        return add_function<checked_call_v<true>>(name, std::forward<Func>(func));
+    }
+
+    // Binds member function given as template argument, e.g. function<&T::method>("method").
+    template <auto Func>
+        requires ValidMemberFunctor<decltype(Func), Type>
+    class_& function(const std::string_view name) {
+        return add_static_function<Func, checked_call_v<false>>(name);
+    }
+
+    template <auto Func>
+        requires ValidMemberFunctor<decltype(Func), Type>
+    class_& function(const std::string_view name, unchecked_t) {
+        return add_static_function<Func, checked_call_v<true>>(name);
+    }
+
+    /**
+     * Declares the field, which scripts can assign to the objects of this type.
+     * Declared fields are kept in the user values of the object instead of its custom table.
+     */
+    class_& field(const std::string_view name) {
+        _info->set_field(_L, name);
+        return *this;
+    }
+
+    // Objects of the sealed type have no custom table, assigning undeclared members raises an error.
+    class_& sealed() {
+        _info->sealed = true;
+        return *this;
+    }
+
+    /**
+     * Objects of this type are represented by the same user data each time they are pushed to lua,
+     * as long as that user data is alive, so they keep their identity and custom fields.
+     * The cached user data is found by the address of the object, the cache doesn't know when C++ destructs it.
+     * If C++ destructs the object, while lua still references it, user_data::forget should be called,
+     * otherwise the new object of the same type at the same address is represented by the old user data.
+     */
+    class_& identity_cache() {
+        _info->identity_cache = true;
         return *this;
     }
 
@@ -89,8 +174,13 @@ public:
     template <typename Functor>
         requires(!std::is_member_object_pointer_v<Functor>)
     class_& property(const std::string_view name, Functor&& getter) {
-        functor_to_lua(_L, std::forward<Functor>(getter));
-        _info->set_property_readonly(_L, std::string {name});
+        using Getter = std::remove_cvref_t<Functor>;
+        if constexpr (NativeAccessor<Getter, 1>) {
+            _info->set_property(_L, name, native_getter(std::forward<Functor>(getter)));
+        } else {
+            functor_to_lua(_L, std::forward<Functor>(getter));
+            _info->set_property_readonly(_L, name);
+        }
         return *this;
     }
 
@@ -111,9 +201,18 @@ public:
     template <typename GetFunctor, typename SetFunctor>
         requires(!std::is_member_object_pointer_v<GetFunctor> && !std::is_member_object_pointer_v<SetFunctor>)
     class_& property(const std::string_view name, GetFunctor&& getter, SetFunctor&& setter) {
-        functor_to_lua(_L, std::forward<GetFunctor>(getter));
-        functor_to_lua(_L, std::forward<SetFunctor>(setter));
-        _info->set_property(_L, std::string {name});
+        using Getter = std::remove_cvref_t<GetFunctor>;
+        using Setter = std::remove_cvref_t<SetFunctor>;
+        if constexpr (NativeAccessor<Getter, 1> && NativeAccessor<Setter, 2>) {
+            _info->set_property(_L,
+                                name,
+                                native_getter(std::forward<GetFunctor>(getter)),
+                                native_setter(std::forward<SetFunctor>(setter)));
+        } else {
+            functor_to_lua(_L, std::forward<GetFunctor>(getter));
+            functor_to_lua(_L, std::forward<SetFunctor>(setter));
+            _info->set_property(_L, name);
+        }
         return *this;
     }
 
@@ -132,19 +231,155 @@ public:
         return *this;
     }
 
+    /**
+     * Binds the typed array accessors together with their bulk companions,
+     * which convert the range of elements in one call:
+     * obj:getRange(first, last) returns the elements [first, last) in a table,
+     * obj:setRange(first, table) assigns the table elements starting at first,
+     * obj:fillRange(first, last, value) assigns the value to the elements [first, last).
+     * The companions can be named differently, the names should not be bound to the type yet.
+     */
+    template <typename GetFunctor>
+    class_& array_range_access(GetFunctor&& getter, const std::string_view get_name = "getRange") {
+        check_range_names({get_name});
+        add_range_function(get_name, &array_range_getter<std::remove_cvref_t<GetFunctor>>::get_range, getter);
+        return array_access(std::forward<GetFunctor>(getter));
+    }
+
+    template <typename GetFunctor, typename SetFunctor>
+        requires(!std::is_convertible_v<SetFunctor, std::string_view>)
+    class_& array_range_access(GetFunctor&& getter,
+                               SetFunctor&& setter,
+                               const std::string_view get_name = "getRange",
+                               const std::string_view set_name = "setRange",
+                               const std::string_view fill_name = "fillRange") {
+        using Setter = std::remove_cvref_t<SetFunctor>;
+        check_range_names({get_name, set_name, fill_name});
+        add_range_function(get_name, &array_range_getter<std::remove_cvref_t<GetFunctor>>::get_range, getter);
+        add_range_function(set_name, &array_range_setter<Setter>::set_range, setter);
+        add_range_function(fill_name, &array_range_setter<Setter>::fill_range, setter);
+        return array_access(std::forward<GetFunctor>(getter), std::forward<SetFunctor>(setter));
+    }
+
+private:
+    template <bool Checked, typename Func>
+    class_& add_class_function(const std::string_view name, Func&& func) {
+        check_class_function_name(name);
+        _info->get_metatable(_L);
+        value_mirror<std::string_view>::to_lua(_L, name);
+        class_functor_to_lua<Func, Checked>(_L, std::forward<Func>(func));
+        lua_rawset(_L, -3);
+        lua_pop(_L, 1); // pop metatable
+        return *this;
+    }
+
+    template <auto Func, bool Checked>
+    class_& add_static_function(const std::string_view name) {
+        static_functor_to_lua<Func, 1, Checked>(_L);
+        _info->set_function(_L, name);
+        return *this;
+    }
+
+    template <auto Func, bool Checked>
+    class_& add_static_class_function(const std::string_view name) {
+        check_class_function_name(name);
+        _info->get_metatable(_L);
+        value_mirror<std::string_view>::to_lua(_L, name);
+        static_functor_to_lua<Func, 2, Checked>(_L);
+        lua_rawset(_L, -3);
+        lua_pop(_L, 1); // pop metatable
+        return *this;
+    }
+
+    template <bool Checked, typename Func>
+    class_& add_function(const std::string_view name, Func&& func) {
+        functor_to_lua<Func, 1, Checked>(_L, std::forward<Func>(func));
+        _info->set_function(_L, name);
+        return *this;
+    }
+
+    void check_class_function_name(const std::string_view name) const {
+        if (name == is_instance_name) {
+            reportError("Class function name '%s' of type '%s' is reserved.", is_instance_name, _info->name.c_str());
+        }
+    }
+
+    // Members are added only if they are not bound yet, so the taken names are reported before adding anything.
+    void check_range_names(std::initializer_list<std::string_view> names) {
+        for (auto it = names.begin(); it != names.end(); ++it) {
+            if (_info->has_entry(_L, *it) || std::find(names.begin(), it, *it) != it) {
+                reportError("Member '%.*s' of type '%s' is already bound.",
+                            static_cast<int>(it->size()),
+                            it->data(),
+                            _info->name.c_str());
+            }
+        }
+    }
+
+    template <typename Functor>
+    void add_range_function(const std::string_view name, lua_CFunction func, const Functor& accessor) {
+        lua_pushlightuserdata(_L, _info->store_accessor(accessor));
+        lua_pushcclosure(_L, func, 1);
+        _info->set_function(_L, name);
+    }
+
+    template <typename Functor>
+    native_accessor native_getter(Functor&& getter) {
+        using Getter = std::remove_cvref_t<Functor>;
+        return native_accessor {&property_getter<Getter>::invoke, _info->store_accessor(std::forward<Functor>(getter))};
+    }
+
+    template <typename Functor>
+    native_accessor native_setter(Functor&& setter) {
+        using Setter = std::remove_cvref_t<Functor>;
+        return native_accessor {&property_setter<Setter>::invoke, _info->store_accessor(std::forward<Functor>(setter))};
+    }
+
+private:
+    // Type:isInstance(obj) checks whether obj is an instance of the Type or of its descendants.
+    static constexpr const char* is_instance_name = "isInstance";
+
+    static int is_instance(lua_State* L) {
+        const user_data* ud = user_data::from_lua(L, 2);
+        const type_info* info = type_storage::find_type_info<Type>(L);
+        lua_pushboolean(L, ud != nullptr && ud->info() != nullptr && type_storage::is_a(L, ud->info(), info));
+        return 1;
+    }
+
 private:
+    // the function_store and the metatable of the type are upvalues of __index and __newindex
+    static constexpr int store_idx = lua_upvalueindex(1);
+    static constexpr int metatable_idx = lua_upvalueindex(2);
+
     static int index_(lua_State* L) {
-        auto* ud = user_data::from_lua(L, 1);
-        int r = index_impl(L, ud->info);
+        auto* ud = check_self(L);
+        int r = index_impl(L, ud);
         if (r >= 0) return r;
         // if there is no result from bound C++, look in the lua table bound to this object
-        user_data::get_custom_table(L, 1); // custom table
+        if (user_data::find_custom_table(L, 1) != LUA_TTABLE) {
+            return 1; // no custom fields were assigned, nil is on the top of the stack
+        }
         lua_pushvalue(L, 2); // key
         lua_rawget(L, -2);
         return 1;
     }
 
-    static int index_impl(lua_State* L, type_info* info) {
+    // Lua calls __index and __newindex with the objects of this metatable, unless they are called directly.
+    static user_data* check_self(lua_State* L) {
+        const bool valid = lua_getmetatable(L, 1) != 0 && lua_rawequal(L, -1, metatable_idx) != 0;
+        if (!valid) [[unlikely]] {
+            luaL_error(L, "Expecting '%s', but got '%s'.", type_name(L), luaL_typename(L, 1));
+        }
+        lua_pop(L, 1);
+        return static_cast<user_data*>(lua_touserdata(L, 1));
+    }
+
+    static const char* type_name(lua_State* L) {
+        return type_storage::find_type_info<Type>(L)->name.c_str();
+    }
+
+    static int index_impl(lua_State* L, user_data* ud) {
+        type_info* info = ud->info();
         const bool is_integer = lua_isinteger(L, 2);
         const int key_type = lua_type(L, 2);
         if (!is_integer && key_type != LUA_TSTRING) {
@@ -152,7 +387,7 @@ private:
         }
         if (is_integer) {
             const int top = lua_gettop(L);
-            int r = info->get_array_getter(L);
+            int r = info->get_array_getter(L, store_idx);
             if (r == LUA_TNIL) {
                 luaL_error(L, "Type '%s' does not provide array get access.", info->name.c_str());
             }
@@ -162,9 +397,12 @@ private:
             return lua_gettop(L) - top;
         }
         // key is a string
-        auto e = info->get_entry(L, 2, false);
+        auto e = info->get_entry(L, 2, false, store_idx);
         switch (e.type) {
         case entry_type::property: {
+            if (e.native_getter) {
+                return e.native_getter(L, ud);
+            }
             const int top = lua_gettop(L) - 1; // -1 for property getter
             lua_pushvalue(L, 1); // self
             lua_call(L, 1, LUA_MULTRET); // call property getter
@@ -172,41 +410,56 @@ private:
         }
         case entry_type::function:
             return 1; // return function on the top of the stack
+        case entry_type::field:
+            lua_getiuservalue(L, 1, e.user_value);
+            return 1;
         case entry_type::none:
             break;
         }
-        //  lua doesn't do recursive index lookup through metatables
-        //  if __index is bound to a C function, so we do it ourselves.
-        for (type_info* base : info->bases) {
-            int r = base->index(L, base);
-            if (r >= 0) {
-                return r;
-            }
-        }
+        // inherited members are already in the type's member table
         return -1;
     }
 
 private:
     static int new_index(lua_State* L) {
-        auto* ud = user_data::from_lua(L, 1);
-        int r = new_index_impl(L, ud->info);
+        auto* ud = check_self(L);
+        int r = new_index_impl(L, ud);
         if (r >= 0) return r;
+        if (ud->info()->sealed) [[unlikely]] {
+            auto key = luaL_tolstring(L, 2, nullptr);
+            return luaL_error(L, "Type '%s' is sealed, can't assign custom field '%s'.", ud->info()->name.c_str(), key);
+        }
         // if there is no result in C++ add new value to the lua table bound to this object
-        user_data::get_custom_table(L, 1); // custom table
+        if (!user_data::try_get_custom_table(L, 1)) [[unlikely]] {
+            return luaL_error(L, "Type '%s' has no custom table.", ud->info()->name.c_str());
+        }
         lua_pushvalue(L, 2); // key
         lua_pushvalue(L, 3); // new value
         lua_rawset(L, -3);
         return 0;
     }
 
-    static int new_index_impl(lua_State* L, type_info* info) {
+    static int method_table_new_index(lua_State* L) {
+        auto* ud = user_data::from_lua(L, 1);
+        if (ud == nullptr) [[unlikely]] {
+            return luaL_error(L, "Expecting '%s', but got '%s'.", type_name(L), luaL_typename(L, 1));
+        }
+        auto key = luaL_tolstring(L, 2, nullptr);
+        return luaL_error(L,
+                          "Type '%s' is bound with a method table, can't assign custom field '%s'.",
+                          ud->info()->name.c_str(),
+                          key);
+    }
+
+    static int new_index_impl(lua_State* L, user_data* ud) {
+        type_info* info = ud->info();
         const bool is_integer = lua_isinteger(L, 2);
         const int key_type = lua_type(L, 2);
         if (!is_integer && key_type != LUA_TSTRING) {
             luaL_error(L, "Key type should be integer or string, '%s' is provided.", lua_typename(L, key_type));
         }
         if (is_integer) {
-            int r = info->get_array_setter(L);
+            int r = info->get_array_setter(L, store_idx);
             if (r == LUA_TNIL) {
                 luaL_error(L, "Type '%s' does not provide array set access.", info->name.c_str());
             }
@@ -218,13 +471,16 @@ private:
             return lua_gettop(L) - top;
         }
         // key is a string
-        auto e = info->get_entry(L, 2, true);
+        auto e = info->get_entry(L, 2, true, store_idx);
         switch (e.type) {
         case entry_type::property: {
             if (!e.has_setter()) {
                 auto key = value_mirror<std::string_view>::from_lua(L, 2);
                 luaL_error(L, "Property '%s' is read only.", key.data());
             }
+            if (e.native_setter) {
+                return e.native_setter(L, ud);
+            }
             const int top = lua_gettop(L) - 1; // -1 for property setter
             lua_pushvalue(L, 1); // self
             lua_pushvalue(L, 3); // value
@@ -233,18 +489,16 @@ private:
         }
         case entry_type::function:
             return -1; // asigning to a function, redirect to custom table
+        case entry_type::field:
+            lua_pushvalue(L, 3); // value
+            if (lua_setiuservalue(L, 1, e.user_value) == 0) {
+                // the object was created before the field was declared
+                luaL_error(L, "Object of type '%s' has no storage for the field.", info->name.c_str());
+            }
+            return 0;
         case entry_type::none:
             break;
         }
-
-        // lua doesn't do recursive index lookup through metatables
-        // if __new_index is bound to a C function, so we do it ourselves.
-        for (type_info* base : info->bases) {
-            int r = base->new_index(L, base);
-            if (r >= 0) {
-                return r;
-            }
-        }
         return -1; // redirect to custom table
     }
 
@@ -253,9 +507,37 @@ private:
     type_info* _info;
 };
 
+/**
+ * Creates the context of luabind in the new lua state, otherwise it is created on the first use.
+ * If LUABIND_USE_EXTRASPACE is defined, it should be called right after the state is created.
+ */
+inline void init(lua_State* L) {
+    type_storage::init(L);
+}
+
 template <typename Functor>
 inline void function(lua_State* L, const std::string_view name, Functor&& func) {
-    functor_to_lua(L, std::forward<Functor>(func));
+    functor_to_lua<Functor, 1, checked_call_v<false>>(L, std::forward<Functor>(func));
+    lua_setglobal(L, name.data());
+}
+
+// Binds global function called without argument checks, see LUABIND_CHECK_LEVEL.
+template <typename Functor>
+inline void function(lua_State* L, const std::string_view name, Functor&& func, unchecked_t) {
+    functor_to_lua<Functor, 1, checked_call_v<true>>(L, std::forward<Functor>(func));
+    lua_setglobal(L, name.data());
+}
+
+// Binds global function given as template argument, e.g. function<&f>(L, "f").
+template <auto Func>
+inline void function(lua_State* L, const std::string_view name) {
+    static_functor_to_lua<Func, 1, checked_call_v<false>>(L);
+    lua_setglobal(L, name.data());
+}
+
+template <auto Func>
+inline void function(lua_State* L, const std::string_view name, unchecked_t) {
+    static_functor_to_lua<Func, 1, checked_call_v<true>>(L);
     lua_setglobal(L, name.data());
 }
 
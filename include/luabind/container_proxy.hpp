@@ -0,0 +1,200 @@
+#ifndef LUABIND_CONTAINER_PROXY_HPP
+#define LUABIND_CONTAINER_PROXY_HPP
+
+#include "lua.hpp"
+
+#include "mirror.hpp"
+#include "object.hpp"
+#include "wrapper.hpp"
+
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+namespace luabind {
+
+/**
+ * Reference to the C++ container, which is passed to lua as a proxy instead of a table,
+ * e.g. function("entities", [](World& w) { return luabind::container_proxy(w.entities); }).
+ * Elements are converted on demand: proxy[i] or proxy[key], #proxy and pairs(proxy).
+ * Elements of the bound types are passed as pointers into the container, so nothing is copied.
+ * Like objects passed by pointer, the container should outlive its proxies.
+ * Associative containers should not be modified while they are iterated by pairs.
+ */
+template <typename Container>
+struct container_proxy {
+    static_assert(!std::is_const_v<Container>, "Proxy of the const container is not supported.");
+
+    Container* container;
+
+    container_proxy(Container& c)
+        : container(&c) {}
+};
+
+/**
+ * Metatable shared by the proxies of the same container type.
+ * The metatable is hidden by __metatable, so the metamethods are called only with the proxies.
+ */
+template <typename Container>
+struct container_proxy_metatable {
+    static constexpr bool associative = requires { typename Container::mapped_type; };
+    using iterator = typename Container::iterator;
+
+    static_assert(associative || std::random_access_iterator<iterator>,
+                  "Only random access sequences and associative containers are supported.");
+
+    static constexpr char key = 0;
+
+    // [-0, +1, m]
+    static void push(lua_State* L) {
+        if (lua_rawgetp(L, LUA_REGISTRYINDEX, &key) == LUA_TTABLE) [[likely]] {
+            return;
+        }
+        lua_pop(L, 1);
+        lua_createtable(L, 0, 4);
+        lua_pushcfunction(L, &index);
+        lua_setfield(L, -2, "__index");
+        lua_pushcfunction(L, &length);
+        lua_setfield(L, -2, "__len");
+        lua_pushcfunction(L, &pairs);
+        lua_setfield(L, -2, "__pairs");
+        lua_pushliteral(L, "container");
+        lua_setfield(L, -2, "__metatable");
+        lua_pushvalue(L, -1);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &key);
+    }
+
+private:
+    static Container& container(lua_State* L, int idx) {
+        return **static_cast<Container**>(lua_touserdata(L, idx));
+    }
+
+    // Objects of the bound types are pushed as pointers to the element, other values are converted.
+    template <typename Element>
+    static int push_element(lua_State* L, Element& e) {
+        if constexpr (std::is_base_of_v<Object, Element> || ValueType<Element>) {
+            return value_mirror<Element*>::to_lua(L, &e);
+        } else {
+            return value_mirror<Element>::to_lua(L, e);
+        }
+    }
+
+    static int index(lua_State* L) {
+        Container& c = container(L, 1);
+        return protected_call(L, [L, &c]() {
+            if constexpr (associative) {
+                // like in lua tables, lookups of the keys of other types miss
+                auto it = c.end();
+                try {
+                    it = c.find(value_mirror<typename Container::key_type>::from_lua(L, 2));
+                } catch (const error&) {
+                }
+                if (it != c.end()) {
+                    return push_element(L, it->second);
+                }
+            } else {
+                int is_integer = 0;
+                const lua_Integer i = lua_tointegerx(L, 2, &is_integer);
+                if (is_integer != 0 && i >= 1 && static_cast<lua_Unsigned>(i) <= std::size(c)) [[likely]] {
+                    return push_element(L, std::begin(c)[i - 1]);
+                }
+            }
+            lua_pushnil(L);
+            return 1;
+        });
+    }
+
+    static int length(lua_State* L) {
+        lua_pushinteger(L, static_cast<lua_Integer>(std::size(container(L, 1))));
+        return 1;
+    }
+
+    /**
+     * Sequences are iterated by index, which is checked against the size on each step,
+     * so they can be modified while iterating.
+     * Associative containers keep the iterator in the closure upvalue, so they should not be modified,
+     * while they are iterated.
+     */
+    static int pairs(lua_State* L) {
+        if constexpr (associative) {
+            new (lua_newuserdatauv(L, sizeof(iterator), 0)) iterator(std::begin(container(L, 1)));
+            if constexpr (!std::is_trivially_destructible_v<iterator>) {
+                push_iterator_metatable(L);
+                lua_setmetatable(L, -2);
+            }
+            lua_pushvalue(L, 1);
+            lua_pushcclosure(L, &next, 2);
+            lua_pushvalue(L, 1);
+            lua_pushnil(L);
+        } else {
+            lua_pushvalue(L, 1);
+            lua_pushcclosure(L, &next, 1);
+            lua_pushvalue(L, 1);
+            lua_pushinteger(L, 0);
+        }
+        return 3;
+    }
+
+    static int next(lua_State* L) {
+        if constexpr (associative) {
+            auto& it = *static_cast<iterator*>(lua_touserdata(L, lua_upvalueindex(1)));
+            Container& c = container(L, lua_upvalueindex(2));
+            if (it == std::end(c)) {
+                lua_pushnil(L);
+                return 1;
+            }
+            auto& e = *it++;
+            return protected_call(L, [L, &e]() {
+                value_mirror<typename Container::key_type>::to_lua(L, e.first);
+                push_element(L, e.second);
+                return 2;
+            });
+        } else {
+            // the iterator function can be called with any arguments, so the proxy is taken from the upvalue
+            Container& c = container(L, lua_upvalueindex(1));
+            const lua_Unsigned i = static_cast<lua_Unsigned>(lua_tointeger(L, 2)) + 1;
+            if (i == 0 || i > std::size(c)) {
+                lua_pushnil(L);
+                return 1;
+            }
+            return protected_call(L, [L, &c, i]() {
+                lua_pushinteger(L, static_cast<lua_Integer>(i));
+                push_element(L, std::begin(c)[i - 1]);
+                return 2;
+            });
+        }
+    }
+
+    // Iterators of the checked standard library are not trivially destructible.
+    static void push_iterator_metatable(lua_State* L) {
+        static constexpr char iterator_key = 0;
+        if (lua_rawgetp(L, LUA_REGISTRYINDEX, &iterator_key) == LUA_TTABLE) [[likely]] {
+            return;
+        }
+        lua_pop(L, 1);
+        lua_createtable(L, 0, 1);
+        lua_pushcfunction(L, [](lua_State* L) -> int {
+            static_cast<iterator*>(lua_touserdata(L, 1))->~iterator();
+            return 0;
+        });
+        lua_setfield(L, -2, "__gc");
+        lua_pushvalue(L, -1);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &iterator_key);
+    }
+};
+
+template <typename Container>
+struct value_mirror<container_proxy<Container>> {
+    using type = container_proxy<Container>;
+
+    static int to_lua(lua_State* L, type proxy) {
+        *static_cast<Container**>(lua_newuserdatauv(L, sizeof(Container*), 0)) = proxy.container;
+        container_proxy_metatable<Container>::push(L);
+        lua_setmetatable(L, -2);
+        return 1;
+    }
+};
+
+} // namespace luabind
+
+#endif // LUABIND_CONTAINER_PROXY_HPP
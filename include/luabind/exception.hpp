@@ -1,7 +1,10 @@
 #ifndef LUABIND_EXCEPTION_HPP
 #define LUABIND_EXCEPTION_HPP
 
+#include "lua.hpp"
+
 #include <cstdarg>
+#include <cstdio>
 #include <exception>
 #include <string>
 #include <string_view>
@@ -33,6 +36,102 @@ private:
     throw error {buffer};
 }
 
+/**
+ * Error policies define how value mirrors and call wrappers report conversion errors.
+ * exception_policy throws luabind::error, which is converted to lua error by the try region of the call wrapper.
+ * lua_error_policy raises lua error directly, so the call wrapper doesn't need a try region.
+ * Unless lua is compiled as C++, lua_error doesn't run destructors of the skipped frames,
+ * so it is used only when all values alive at that point are trivially destructible.
+ */
+struct exception_policy {
+    static constexpr bool checked = true;
+
+    [[noreturn]] [[gnu::format(printf, 2, 3)]] static void report(lua_State*, const char* fmt, ...) {
+        std::va_list args;
+        va_start(args, fmt);
+        constexpr size_t bufferSize = 256;
+        char buffer[bufferSize];
+        std::vsnprintf(buffer, bufferSize, fmt, args);
+        va_end(args);
+        throw error {buffer};
+    }
+};
+
+struct lua_error_policy {
+    static constexpr bool checked = true;
+
+    [[noreturn]] [[gnu::format(printf, 2, 3)]] static void report(lua_State* L, const char* fmt, ...) {
+        std::va_list args;
+        va_start(args, fmt);
+        constexpr size_t bufferSize = 256;
+        char buffer[bufferSize];
+        std::vsnprintf(buffer, bufferSize, fmt, args);
+        va_end(args);
+        lua_pushstring(L, buffer);
+        lua_error(L);
+        std::terminate(); // lua_error doesn't return
+    }
+};
+
+/**
+ * Policy for the trusted calls, mirrors skip the argument type checks and use raw conversions.
+ * Errors, which still can be detected, are reported by the base policy.
+ */
+template <typename Policy>
+struct unchecked_policy : Policy {
+    static constexpr bool checked = false;
+};
+
+/**
+ * Policy of the container element conversions, errors are always thrown and caught by the container mirror,
+ * which reports them by the base policy as errors of the container argument at the position of the element.
+ */
+template <typename Policy>
+struct element_policy : Policy {
+    [[noreturn]] [[gnu::format(printf, 2, 3)]] static void report(lua_State*, const char* fmt, ...) {
+        std::va_list args;
+        va_start(args, fmt);
+        constexpr size_t bufferSize = 256;
+        char buffer[bufferSize];
+        std::vsnprintf(buffer, bufferSize, fmt, args);
+        va_end(args);
+        throw error {buffer};
+    }
+};
+
+/**
+ * Check level of the bound calls:
+ * 0 - argument count and types are not checked,
+ * 1 - functions bound with luabind::unchecked are not checked, others are,
+ * 2 - everything is checked.
+ * Debug builds check everything by default.
+ */
+#ifndef LUABIND_CHECK_LEVEL
+#ifdef NDEBUG
+#define LUABIND_CHECK_LEVEL 1
+#else
+#define LUABIND_CHECK_LEVEL 2
+#endif // NDEBUG
+#endif // LUABIND_CHECK_LEVEL
+
+#ifdef LUABIND_LUA_CPP
+// lua throws C++ exception to report errors, destructors are called
+inline constexpr bool lua_error_unwinds = true;
+#else
+inline constexpr bool lua_error_unwinds = false;
+#endif // LUABIND_LUA_CPP
+
+#ifdef LUABIND_NOTHROW_CALLS
+// bound callables are assumed not to throw, even if they are not declared noexcept
+inline constexpr bool nothrow_calls = true;
+#else
+inline constexpr bool nothrow_calls = false;
+#endif // LUABIND_NOTHROW_CALLS
+
+// Callables, which report errors by exceptions, are called in the try region even with LUABIND_NOTHROW_CALLS.
+template <typename Functor>
+inline constexpr bool throwing_callable_v = false;
+
 } // namespace luabind
 
 #endif // LUABIND_EXCEPTION_HPP
@@ -42,6 +42,25 @@ struct function_first_arg_helper<R(First, Args...) const noexcept> {
 template <typename T>
 using function_first_arg_t = typename function_first_arg_helper<T>::type;
 
+template <typename T>
+struct function_second_arg_helper {
+    using type = void;
+};
+
+template <typename R, typename First, typename Second, typename... Args>
+struct function_second_arg_helper<R(First, Second, Args...)> {
+    using type = Second;
+};
+
+template <typename T>
+using function_second_arg_t = typename function_second_arg_helper<T>::type;
+
+template <typename T>
+struct function_arity_helper;
+
+template <typename R, typename... Args>
+struct function_arity_helper<R(Args...)> : std::integral_constant<size_t, sizeof...(Args)> {};
+
 template <typename T>
 struct callable_object_helper;
 
@@ -129,6 +148,9 @@ using signature_t = typename callable_helper<std::remove_cvref_t<F>>::type;
 template <typename F>
 using first_arg_t = function_first_arg_t<signature_t<F>>;
 
+template <typename F>
+constexpr size_t arity_v = function_arity_helper<signature_t<F>>::value;
+
 template <typename T>
 using strip_t = std::remove_const_t<std::remove_pointer_t<std::remove_cvref_t<T>>>;
 
@@ -6,8 +6,16 @@
 #include "type_storage.hpp"
 #include "user_data.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace luabind {
 
@@ -24,8 +32,9 @@ struct value_mirror {
         return lua_user_data<T>::to_lua(L, std::forward<Args>(args)...);
     }
 
+    template <typename Policy = exception_policy>
     static const T& from_lua(lua_State* L, int idx) {
-        return *(value_mirror<T*>::from_lua(L, idx));
+        return *(value_mirror<T*>::template from_lua<Policy>(L, idx));
     }
 };
 
@@ -39,23 +48,58 @@ struct value_mirror<T*> {
         return 1;
     }
 
+    template <typename Policy = exception_policy>
     static T* from_lua(lua_State* L, int idx) {
+        if constexpr (!Policy::checked) {
+            auto* ud = static_cast<user_data*>(lua_touserdata(L, idx));
+            return ud != nullptr && ud->object != nullptr ? cast(ud) : nullptr;
+        }
         auto* ud = user_data::from_lua(L, idx);
         if (ud == nullptr) [[unlikely]] {
-            reportError("Argument at %i has invalid type. Expecting user_data of type '%s', but got lua type '%s'",
-                        idx,
-                        type_storage::type_name<T>(L).data(),
-                        lua_typename(L, lua_type(L, idx)));
-        }
-        auto p = dynamic_cast<T*>(ud->object);
-        if (p == nullptr && ud->object != nullptr) [[unlikely]] {
-            reportError("Argument at %i has invalid type. Expecting '%s' but got '%s'.",
-                        idx,
-                        type_storage::type_name<T>(L).data(),
-                        ud->info->name.c_str());
+            Policy::report(L,
+                           "Argument at %i has invalid type. Expecting user_data of type '%s', but got lua type '%s'",
+                           idx,
+                           type_storage::type_name<T>(L).data(),
+                           lua_typename(L, lua_type(L, idx)));
+        }
+        return from_user_data<Policy>(L, ud, idx);
+    }
+
+    // idx is used only for error reporting
+    template <typename Policy = exception_policy>
+    static T* from_user_data(lua_State* L, user_data* ud, int idx) {
+        if (ud->object == nullptr) [[unlikely]] {
+            return nullptr;
+        }
+        auto p = cast(ud);
+        if (p == nullptr) [[unlikely]] {
+            Policy::report(L,
+                           "Argument at %i has invalid type. Expecting '%s' but got '%s'.",
+                           idx,
+                           type_storage::type_name<T>(L).data(),
+                           ud->info()->name.c_str());
         }
         return p;
     }
+
+    // Returns nullptr if the object is not of type T.
+    static T* cast(user_data* ud) {
+        if (type_info* info = ud->info(); info != nullptr) [[likely]] {
+            // offsets of the bound hierarchy are known, dynamic_cast is needed only for virtual and unbound bases
+            void* p = info->cast(ud->object, type_slot<raw_type>());
+            if (p != nullptr) [[likely]] {
+                return static_cast<T*>(p);
+            }
+            if (info->value_type) {
+                return nullptr;
+            }
+        }
+        if constexpr (ValueType<raw_type>) {
+            return nullptr;
+        } else {
+            return dynamic_cast<T*>(static_cast<Object*>(ud->object));
+        }
+    }
 };
 
 template <typename T>
@@ -64,8 +108,9 @@ struct value_mirror<T&> {
         return value_mirror<T*>::to_lua(L, &v);
     }
 
+    template <typename Policy = exception_policy>
     static T& from_lua(lua_State* L, int idx) {
-        return *value_mirror<T*>::from_lua(L, idx);
+        return *value_mirror<T*>::template from_lua<Policy>(L, idx);
     }
 };
 
@@ -77,26 +122,31 @@ struct value_mirror<std::shared_ptr<T>> {
         return shared_user_data::to_lua(L, std::move(v));
     }
 
+    template <typename Policy = exception_policy>
     static type from_lua(lua_State* L, int idx) {
         auto* ud = user_data::from_lua(L, idx);
         if (ud == nullptr) [[unlikely]] {
-            reportError("Argument at %i has invalid type. Expecting user_data of type '%s', but got lua type '%s'",
-                        idx,
-                        type_storage::type_name<T>(L).data(),
-                        lua_typename(L, lua_type(L, idx)));
+            Policy::report(L,
+                           "Argument at %i has invalid type. Expecting user_data of type '%s', but got lua type '%s'",
+                           idx,
+                           type_storage::type_name<T>(L).data(),
+                           lua_typename(L, lua_type(L, idx)));
+        }
+        if (ud->lifetime() != memory_lifetime::shared) [[unlikely]] {
+            Policy::report(L, "Argument at %i is not a shared_ptr.", idx);
         }
-        auto sud = dynamic_cast<shared_user_data*>(ud);
-        if (sud == nullptr) [[unlikely]] {
-            reportError("Argument at %i is not a shared_ptr.", idx);
+        if (ud->object == nullptr) [[unlikely]] {
+            return nullptr;
         }
-        auto r = std::dynamic_pointer_cast<T>(sud->data);
-        if (!r && sud->data) [[unlikely]] {
-            reportError("Argument at %i has invalid type. Expecing '%s' but got '%s'.",
-                        idx,
-                        type_storage::type_name<T>(L).data(),
-                        ud->info->name.c_str());
+        T* p = value_mirror<T*>::cast(ud);
+        if (p == nullptr) [[unlikely]] {
+            Policy::report(L,
+                           "Argument at %i has invalid type. Expecing '%s' but got '%s'.",
+                           idx,
+                           type_storage::type_name<T>(L).data(),
+                           ud->info()->name.c_str());
         }
-        return r;
+        return std::shared_ptr<T>(static_cast<shared_user_data*>(ud)->data, p);
     }
 };
 
@@ -109,6 +159,37 @@ struct value_mirror<std::shared_ptr<T>&> {};
 template <typename T>
 struct value_mirror<std::shared_ptr<T>&&> {};
 
+template <typename T>
+struct value_mirror<ref_ptr<T>> {
+    using type = ref_ptr<T>;
+
+    static int to_lua(lua_State* L, const type& v) {
+        return intrusive_user_data::to_lua(L, v.get());
+    }
+
+    template <typename Policy = exception_policy>
+    static type from_lua(lua_State* L, int idx) {
+        T* p = value_mirror<T*>::template from_lua<Policy>(L, idx);
+        if (p == nullptr) [[unlikely]] {
+            return nullptr;
+        }
+        // only objects owned by the reference count can be shared, the others can be destructed regardless of it
+        if (static_cast<user_data*>(lua_touserdata(L, idx))->lifetime() != memory_lifetime::intrusive) [[unlikely]] {
+            Policy::report(L, "Argument at %i is not a ref_ptr.", idx);
+        }
+        return ref_ptr<T>(p);
+    }
+};
+
+template <typename T>
+struct value_mirror<const ref_ptr<T>&> : value_mirror<ref_ptr<T>> {};
+
+template <typename T>
+struct value_mirror<ref_ptr<T>&> {};
+
+template <typename T>
+struct value_mirror<ref_ptr<T>&&> {};
+
 template <>
 struct value_mirror<bool> {
     using type = bool;
@@ -118,12 +199,13 @@ struct value_mirror<bool> {
         return 1;
     }
 
+    template <typename Policy = exception_policy>
     static bool from_lua(lua_State* L, int idx) {
-        int isb = lua_isboolean(L, idx);
-        if (isb != 1) [[unlikely]] {
-            reportError("Argument at %i has invalid type. Expecting 'boolean', but got '%s'.",
-                        idx,
-                        lua_typename(L, lua_type(L, idx)));
+        if (Policy::checked && lua_isboolean(L, idx) != 1) [[unlikely]] {
+            Policy::report(L,
+                           "Argument at %i has invalid type. Expecting 'boolean', but got '%s'.",
+                           idx,
+                           lua_typename(L, lua_type(L, idx)));
         }
         int r = lua_toboolean(L, idx);
         return static_cast<bool>(r);
@@ -145,25 +227,34 @@ struct number_mirror {
         return 1;
     }
 
+    template <typename Policy = exception_policy>
     static raw_type from_lua(lua_State* L, int idx) {
         if constexpr (std::is_integral_v<raw_type>) {
-            if (0 == lua_isinteger(L, idx)) {
-                reportError("Argument at %i has invalid type. Expecting 'integer', but got '%s'.",
-                            idx,
-                            lua_typename(L, lua_type(L, idx)));
+            if (Policy::checked && 0 == lua_isinteger(L, idx)) {
+                Policy::report(L,
+                               "Argument at %i has invalid type. Expecting 'integer', but got '%s'.",
+                               idx,
+                               lua_typename(L, lua_type(L, idx)));
             }
             return static_cast<raw_type>(lua_tointeger(L, idx));
         } else {
-            if (lua_type(L, idx) != LUA_TNUMBER) {
-                reportError("Argument at %i has invalid type. Expecting 'number', but got '%s'.",
-                            idx,
-                            lua_typename(L, lua_type(L, idx)));
+            if (Policy::checked && lua_type(L, idx) != LUA_TNUMBER) {
+                Policy::report(L,
+                               "Argument at %i has invalid type. Expecting 'number', but got '%s'.",
+                               idx,
+                               lua_typename(L, lua_type(L, idx)));
             }
             return static_cast<raw_type>(lua_tonumber(L, idx));
         }
     }
 };
 
+template <>
+struct value_mirror<char> : number_mirror<char> {};
+template <>
+struct value_mirror<signed char> : number_mirror<signed char> {};
+template <>
+struct value_mirror<unsigned char> : number_mirror<unsigned char> {};
 template <>
 struct value_mirror<short> : number_mirror<short> {};
 template <>
@@ -186,6 +277,8 @@ template <>
 struct value_mirror<float> : number_mirror<float> {};
 template <>
 struct value_mirror<double> : number_mirror<double> {};
+template <>
+struct value_mirror<long double> : number_mirror<long double> {};
 
 template <>
 struct value_mirror<std::string_view> {
@@ -194,11 +287,13 @@ struct value_mirror<std::string_view> {
         return 1;
     }
 
+    template <typename Policy = exception_policy>
     static std::string_view from_lua(lua_State* L, int idx) {
-        if (lua_type(L, idx) != LUA_TSTRING) {
-            reportError("Argument at %i has invalid type. Expecting 'string', but got '%s'.",
-                        idx,
-                        lua_typename(L, lua_type(L, idx)));
+        if (Policy::checked && lua_type(L, idx) != LUA_TSTRING) {
+            Policy::report(L,
+                           "Argument at %i has invalid type. Expecting 'string', but got '%s'.",
+                           idx,
+                           lua_typename(L, lua_type(L, idx)));
         }
         size_t len;
         const char* lv = lua_tolstring(L, idx, &len);
@@ -224,8 +319,9 @@ struct value_mirror<std::string> {
         return value_mirror<std::string_view>::to_lua(L, v);
     }
 
+    template <typename Policy = exception_policy>
     static std::string from_lua(lua_State* L, int idx) {
-        return std::string {value_mirror<std::string_view>::from_lua(L, idx)};
+        return std::string {value_mirror<std::string_view>::from_lua<Policy>(L, idx)};
     }
 };
 
@@ -241,6 +337,210 @@ struct value_mirror<std::string*> {};
 template <>
 struct value_mirror<const std::string*> {};
 
+/**
+ * Containers are converted to lua tables and back in one pass, the elements are converted by their mirrors,
+ * so the containers can be nested. Tables are presized and accessed without metamethods.
+ */
+template <typename Policy>
+int check_table(lua_State* L, int idx) {
+    if (Policy::checked && lua_type(L, idx) != LUA_TTABLE) [[unlikely]] {
+        Policy::report(L,
+                       "Argument at %i has invalid type. Expecting 'table', but got '%s'.",
+                       idx,
+                       lua_typename(L, lua_type(L, idx)));
+    }
+    // nested conversions push values, so the index should not be relative
+    idx = lua_absindex(L, idx);
+    if (lua_checkstack(L, 3) == 0) [[unlikely]] {
+        Policy::report(L, "Argument at %i is nested too deep, lua stack overflow.", idx);
+    }
+    return idx;
+}
+
+/**
+ * Converts the element of the container argument at idx, which is at elementIdx on the stack.
+ * Errors of the element mirror are reported by Policy with the argument index and the element position,
+ * which is written by position(buffer, size) only in case of the error.
+ * The message is copied out of the handler, as lua_error_policy doesn't return.
+ */
+template <typename T, typename Policy, typename Position>
+decltype(auto) element_from_lua(lua_State* L, int idx, int elementIdx, Position&& position) {
+    constexpr size_t bufferSize = 256;
+    char message[bufferSize];
+    const int top = lua_gettop(L);
+    try {
+        return value_mirror<T>::template from_lua<element_policy<Policy>>(L, elementIdx);
+    } catch (const error& e) {
+        std::snprintf(message, bufferSize, "%s", e.what());
+    }
+    lua_settop(L, top);
+    char element[bufferSize / 4];
+    position(element, sizeof(element));
+    // errors of the elements refer to the element by its stack index, which is replaced with the position
+    constexpr std::string_view prefix = "Argument at ";
+    std::string_view rest = message;
+    if (rest.starts_with(prefix)) {
+        rest.remove_prefix(std::min(rest.find_first_not_of("-0123456789", prefix.size()), rest.size()));
+        Policy::report(L, "Argument at %i, %s%.*s", idx, element, static_cast<int>(rest.size()), rest.data());
+    }
+    Policy::report(L, "Argument at %i, %s: %s", idx, element, message);
+}
+
+template <typename Container>
+struct sequence_mirror {
+    using value_type = typename Container::value_type;
+
+    static int to_lua(lua_State* L, const Container& v) {
+        luaL_checkstack(L, 2, "containers are nested too deep");
+        lua_createtable(L, static_cast<int>(v.size()), 0);
+        lua_Integer i = 0;
+        for (const auto& e : v) {
+            value_mirror<value_type>::to_lua(L, e);
+            lua_rawseti(L, -2, ++i);
+        }
+        return 1;
+    }
+
+protected:
+    // Converts the elements of the table to out, which has room for size elements.
+    template <typename Policy, typename OutputIt>
+    static void elements_from_lua(lua_State* L, int idx, size_t size, OutputIt out) {
+        for (size_t i = 1; i <= size; ++i) {
+            lua_rawgeti(L, idx, static_cast<lua_Integer>(i));
+            *out++ = element_from_lua<value_type, Policy>(L, idx, -1, [i](char* buffer, size_t size) {
+                std::snprintf(buffer, size, "element %zu", i);
+            });
+            lua_pop(L, 1);
+        }
+    }
+};
+
+template <typename T, typename Allocator>
+struct value_mirror<std::vector<T, Allocator>> : sequence_mirror<std::vector<T, Allocator>> {
+    using type = std::vector<T, Allocator>;
+
+    template <typename Policy = exception_policy>
+    static type from_lua(lua_State* L, int idx) {
+        idx = check_table<Policy>(L, idx);
+        const size_t size = lua_rawlen(L, idx);
+        type v;
+        v.reserve(size);
+        value_mirror::template elements_from_lua<Policy>(L, idx, size, std::back_inserter(v));
+        return v;
+    }
+};
+
+template <typename T, typename Allocator>
+struct value_mirror<const std::vector<T, Allocator>> : value_mirror<std::vector<T, Allocator>> {};
+
+template <typename T, typename Allocator>
+struct value_mirror<const std::vector<T, Allocator>&> : value_mirror<std::vector<T, Allocator>> {};
+
+template <typename T, size_t N>
+struct value_mirror<std::array<T, N>> : sequence_mirror<std::array<T, N>> {
+    using type = std::array<T, N>;
+
+    template <typename Policy = exception_policy>
+    static type from_lua(lua_State* L, int idx) {
+        idx = check_table<Policy>(L, idx);
+        const size_t size = lua_rawlen(L, idx);
+        if (size != N) [[unlikely]] {
+            Policy::report(L, "Argument at %i should have %zu elements, but has %zu.", idx, N, size);
+        }
+        type v {};
+        value_mirror::template elements_from_lua<Policy>(L, idx, N, v.begin());
+        return v;
+    }
+};
+
+template <typename T, size_t N>
+struct value_mirror<const std::array<T, N>> : value_mirror<std::array<T, N>> {};
+
+template <typename T, size_t N>
+struct value_mirror<const std::array<T, N>&> : value_mirror<std::array<T, N>> {};
+
+template <typename Map>
+struct map_mirror {
+    using type = Map;
+    using key_type = typename Map::key_type;
+    using mapped_type = typename Map::mapped_type;
+
+    static int to_lua(lua_State* L, const Map& m) {
+        luaL_checkstack(L, 3, "containers are nested too deep");
+        lua_createtable(L, 0, static_cast<int>(m.size()));
+        for (const auto& [key, value] : m) {
+            value_mirror<key_type>::to_lua(L, key);
+            value_mirror<mapped_type>::to_lua(L, value);
+            lua_rawset(L, -3);
+        }
+        return 1;
+    }
+
+    template <typename Policy = exception_policy>
+    static Map from_lua(lua_State* L, int idx) {
+        idx = check_table<Policy>(L, idx);
+        Map m;
+        lua_pushnil(L);
+        while (lua_next(L, idx) != 0) {
+            const int keyIdx = lua_absindex(L, -2);
+            // key is converted from its copy, because the conversion can change it in place and break lua_next
+            lua_pushvalue(L, keyIdx);
+            auto key = element_from_lua<key_type, Policy>(L, idx, -1, [L, keyIdx](char* buffer, size_t size) {
+                describe_key(L, keyIdx, "key", buffer, size);
+            });
+            auto value =
+                element_from_lua<mapped_type, Policy>(L, idx, keyIdx + 1, [L, keyIdx](char* buffer, size_t size) {
+                    describe_key(L, keyIdx, "value of key", buffer, size);
+                });
+            m.emplace(std::move(key), std::move(value));
+            lua_pop(L, 2);
+        }
+        return m;
+    }
+
+private:
+    static void describe_key(lua_State* L, int keyIdx, const char* what, char* buffer, size_t size) {
+        switch (lua_type(L, keyIdx)) {
+        case LUA_TNUMBER:
+            if (lua_isinteger(L, keyIdx)) {
+                std::snprintf(buffer, size, "%s %lli", what, static_cast<long long>(lua_tointeger(L, keyIdx)));
+            } else {
+                std::snprintf(buffer, size, "%s %g", what, lua_tonumber(L, keyIdx));
+            }
+            break;
+        case LUA_TSTRING:
+            std::snprintf(buffer, size, "%s '%s'", what, lua_tostring(L, keyIdx));
+            break;
+        default:
+            std::snprintf(buffer, size, "%s of type '%s'", what, luaL_typename(L, keyIdx));
+        }
+    }
+};
+
+template <typename Key, typename T, typename Compare, typename Allocator>
+struct value_mirror<std::map<Key, T, Compare, Allocator>>
+    : map_mirror<std::map<Key, T, Compare, Allocator>> {};
+
+template <typename Key, typename T, typename Compare, typename Allocator>
+struct value_mirror<const std::map<Key, T, Compare, Allocator>>
+    : map_mirror<std::map<Key, T, Compare, Allocator>> {};
+
+template <typename Key, typename T, typename Compare, typename Allocator>
+struct value_mirror<const std::map<Key, T, Compare, Allocator>&>
+    : map_mirror<std::map<Key, T, Compare, Allocator>> {};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+struct value_mirror<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>>
+    : map_mirror<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>> {};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+struct value_mirror<const std::unordered_map<Key, T, Hash, KeyEqual, Allocator>>
+    : map_mirror<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>> {};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+struct value_mirror<const std::unordered_map<Key, T, Hash, KeyEqual, Allocator>&>
+    : map_mirror<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>> {};
+
 } // namespace luabind
 
 #endif // LUABIND_MIRROR_HPP
@@ -0,0 +1,270 @@
+#ifndef LUABIND_NUMERIC_ARRAY_HPP
+#define LUABIND_NUMERIC_ARRAY_HPP
+
+#include "bind.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+namespace luabind {
+
+/**
+ * Contiguous array of numbers owned by lua, which operations process the whole array in one call
+ * by the vectorized kernels, see simd.hpp.
+ * Elements are stored in the same user data right after the size, so lua accounts their memory.
+ * Elements are 1-based in lua: a[i], #a, and in the get and set functions.
+ */
+template <typename T>
+class numeric_array final {
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, std::int64_t>,
+                  "Only float, double and int64 arrays are supported.");
+
+public:
+    using value_type = T;
+
+    // elements are not copied with the array
+    numeric_array(const numeric_array&) = delete;
+    numeric_array& operator=(const numeric_array&) = delete;
+
+    size_t size() const {
+        return m_size;
+    }
+
+    T* data() {
+        static_assert(alignof(numeric_array) >= alignof(T));
+        return reinterpret_cast<T*>(this + 1);
+    }
+
+    const T* data() const {
+        return reinterpret_cast<const T*>(this + 1);
+    }
+
+    T get(size_t idx) const {
+        check_index(idx);
+        return data()[idx - 1];
+    }
+
+    void set(size_t idx, T value) {
+        check_index(idx);
+        data()[idx - 1] = value;
+    }
+
+    // this[i] += other[i]
+    void add(const numeric_array& other) {
+        check_size(other);
+        simd::transform(data(), size(), [](auto a, auto b) { return simd::add(a, b); }, data(), other.data());
+    }
+
+    // this[i] *= other[i]
+    void mul(const numeric_array& other) {
+        check_size(other);
+        simd::transform(data(), size(), [](auto a, auto b) { return simd::mul(a, b); }, data(), other.data());
+    }
+
+    // this[i] += a[i] * b[i]
+    void fma(const numeric_array& a, const numeric_array& b) {
+        check_size(a);
+        check_size(b);
+        simd::transform(
+            data(), size(), [](auto c, auto x, auto y) { return simd::fmadd(x, y, c); }, data(), a.data(), b.data());
+    }
+
+    // this[i] *= factor
+    void scale(T factor) {
+        simd::transform(
+            data(),
+            size(),
+            [factor](auto a) { return simd::mul(a, simd::splat<decltype(a)>(factor)); },
+            data());
+    }
+
+    // this[i] = min(max(this[i], low), high)
+    void clamp(T low, T high) {
+        simd::transform(
+            data(),
+            size(),
+            [low, high](auto a) {
+                using V = decltype(a);
+                return simd::min(simd::max(a, simd::splat<V>(low)), simd::splat<V>(high));
+            },
+            data());
+    }
+
+    T dot(const numeric_array& other) const {
+        check_size(other);
+        return simd::reduce(
+            size(),
+            T {},
+            [](auto acc, auto a, auto b) { return simd::fmadd(a, b, acc); },
+            [](T a, T b) { return a + b; },
+            data(),
+            other.data());
+    }
+
+    T sum() const {
+        auto add = [](auto a, auto b) { return simd::add(a, b); };
+        return simd::reduce(size(), T {}, add, add, data());
+    }
+
+    T min() const {
+        check_not_empty();
+        auto min = [](auto a, auto b) { return simd::min(a, b); };
+        return simd::reduce(size(), data()[0], min, min, data());
+    }
+
+    T max() const {
+        check_not_empty();
+        auto max = [](auto a, auto b) { return simd::max(a, b); };
+        return simd::reduce(size(), data()[0], max, max, data());
+    }
+
+    /**
+     * Binds the array type with the given name and returns the class for further bindings.
+     * Type:new(size[, value]) or Type:new(table) creates the array, a + b and a * b create new arrays,
+     * a * b multiplies elements or scales the array if one of the operands is a number.
+     */
+    static class_<numeric_array> bind(lua_State* L, const std::string_view name) {
+        class_<numeric_array> c(L, name);
+        c.constructor("new", &create)
+            .array_range_access(&numeric_array::get, &numeric_array::set)
+            .function("size", &numeric_array::size)
+            .function("add", &numeric_array::add)
+            .function("mul", &numeric_array::mul)
+            .function("fma", &numeric_array::fma)
+            .function("scale", &numeric_array::scale)
+            .function("clamp", &numeric_array::clamp)
+            .function("dot", &numeric_array::dot)
+            .function("sum", &numeric_array::sum)
+            .function("min", &numeric_array::min)
+            .function("max", &numeric_array::max);
+
+        type_storage::find_type_info<numeric_array>(L)->get_metatable(L);
+        lua_pushcfunction(L, &length);
+        lua_setfield(L, -2, "__len");
+        lua_pushcfunction(L, &sum_arrays);
+        lua_setfield(L, -2, "__add");
+        lua_pushcfunction(L, &mul_arrays);
+        lua_setfield(L, -2, "__mul");
+        lua_pop(L, 1); // pop metatable
+        return c;
+    }
+
+private:
+    friend class lua_user_data<numeric_array>;
+
+    // Constructed only by push, which allocates the elements after the array.
+    explicit numeric_array(size_t size, T value)
+        : m_size(size) {
+        std::uninitialized_fill_n(data(), size, value);
+    }
+
+    void check_index(size_t idx) const {
+        if (idx < 1 || idx > size()) [[unlikely]] {
+            reportError("Index %zu is out of array range [1, %zu].", idx, size());
+        }
+    }
+
+    void check_size(const numeric_array& other) const {
+        if (other.size() != size()) [[unlikely]] {
+            reportError("Array sizes differ, %zu and %zu.", size(), other.size());
+        }
+    }
+
+    void check_not_empty() const {
+        if (m_size == 0) [[unlikely]] {
+            reportError("Array is empty.");
+        }
+    }
+
+    // Pushes the new array of the given size, which elements are set to the value or by the kernel.
+    static numeric_array& push(lua_State* L, size_t size, T value = T {}) {
+        constexpr size_t max_size = (std::numeric_limits<size_t>::max() - sizeof(numeric_array)) / sizeof(T);
+        if (size > max_size) [[unlikely]] {
+            reportError("Array size %zu is too large.", size);
+        }
+        lua_user_data<numeric_array>::to_lua_with_trailing(L, size * sizeof(T), size, value);
+        return *value_mirror<numeric_array*>::from_lua(L, -1);
+    }
+
+    static int create(lua_State* L) {
+        // 1st argument is the metatable
+        return protected_call(L, [L]() {
+            if (lua_type(L, 2) == LUA_TTABLE) {
+                const size_t size = lua_rawlen(L, 2);
+                numeric_array& array = push(L, size);
+                T* elements = array.data();
+                for (size_t i = 0; i < size; ++i) {
+                    lua_rawgeti(L, 2, static_cast<lua_Integer>(i + 1));
+                    elements[i] = element_from_lua<T, exception_policy>(L, 2, -1, [i](char* buffer, size_t size) {
+                        std::snprintf(buffer, size, "element %zu", i + 1);
+                    });
+                    lua_pop(L, 1);
+                }
+                return 1;
+            }
+            const auto size = value_mirror<lua_Integer>::from_lua(L, 2);
+            if (size < 0) {
+                reportError("Array size should not be negative, but %lli is given.", static_cast<long long>(size));
+            }
+            const T value = lua_isnoneornil(L, 3) ? T {} : value_mirror<T>::from_lua(L, 3);
+            push(L, static_cast<size_t>(size), value);
+            return 1;
+        });
+    }
+
+    static int length(lua_State* L) {
+        const auto& self = value_mirror<numeric_array>::template from_lua<lua_error_policy>(L, 1);
+        lua_pushinteger(L, static_cast<lua_Integer>(self.size()));
+        return 1;
+    }
+
+    static int sum_arrays(lua_State* L) {
+        return protected_call(L, [L]() {
+            const auto& a = value_mirror<numeric_array>::from_lua(L, 1);
+            const auto& b = value_mirror<numeric_array>::from_lua(L, 2);
+            a.check_size(b);
+            numeric_array& r = push(L, a.size());
+            simd::transform(r.data(), r.size(), [](auto x, auto y) { return simd::add(x, y); }, a.data(), b.data());
+            return 1;
+        });
+    }
+
+    static int mul_arrays(lua_State* L) {
+        return protected_call(L, [L]() {
+            if (lua_type(L, 1) == LUA_TNUMBER || lua_type(L, 2) == LUA_TNUMBER) {
+                const int array_idx = lua_type(L, 1) == LUA_TNUMBER ? 2 : 1;
+                const auto& a = value_mirror<numeric_array>::from_lua(L, array_idx);
+                const T factor = value_mirror<T>::from_lua(L, 3 - array_idx);
+                numeric_array& r = push(L, a.size());
+                simd::transform(
+                    r.data(),
+                    r.size(),
+                    [factor](auto x) { return simd::mul(x, simd::splat<decltype(x)>(factor)); },
+                    a.data());
+                return 1;
+            }
+            const auto& a = value_mirror<numeric_array>::from_lua(L, 1);
+            const auto& b = value_mirror<numeric_array>::from_lua(L, 2);
+            a.check_size(b);
+            numeric_array& r = push(L, a.size());
+            simd::transform(r.data(), r.size(), [](auto x, auto y) { return simd::mul(x, y); }, a.data(), b.data());
+            return 1;
+        });
+    }
+
+    size_t m_size;
+};
+
+// Members report invalid indices and sizes by exceptions.
+template <typename T, typename Member>
+inline constexpr bool throwing_callable_v<Member numeric_array<T>::*> = true;
+
+} // namespace luabind
+
+#endif // LUABIND_NUMERIC_ARRAY_HPP
@@ -1,6 +1,8 @@
 #ifndef LUABIND_OBJECT_HPP
 #define LUABIND_OBJECT_HPP
 
+#include <type_traits>
+
 namespace luabind {
 
 class Object {
@@ -10,6 +12,14 @@ public:
 
 inline Object::~Object() = default;
 
+/**
+ * Lightweight type, which is bound without luabind::Object base.
+ * It is final and not polymorphic, so its objects are identified by the bound type alone
+ * and are stored in the user data without vtable.
+ */
+template <typename T>
+concept ValueType = std::is_class_v<T> && std::is_final_v<T> && !std::is_polymorphic_v<T>;
+
 } // namespace luabind
 
 #endif // LUABIND_OBJECT_HPP
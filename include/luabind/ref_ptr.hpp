@@ -0,0 +1,166 @@
+#ifndef LUABIND_REF_PTR_HPP
+#define LUABIND_REF_PTR_HPP
+
+#include "object.hpp"
+
+#include <cstddef>
+#include <utility>
+
+#ifdef LUABIND_ATOMIC_REFCOUNT
+#include <atomic>
+#endif // LUABIND_ATOMIC_REFCOUNT
+
+namespace luabind {
+
+/**
+ * Base of the objects with intrusive reference count, which are owned by ref_ptr and lua together.
+ * Objects are destructed by delete, so they should be allocated by new, e.g. with make_ref.
+ * Lua state is used by one thread, so the count is not atomic, unless LUABIND_ATOMIC_REFCOUNT is defined.
+ */
+class RefCounted : public Object {
+public:
+#ifdef LUABIND_ATOMIC_REFCOUNT
+    void add_ref() const noexcept {
+        m_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() const noexcept {
+        if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    size_t ref_count() const noexcept {
+        return m_refs.load(std::memory_order_relaxed);
+    }
+#else
+    void add_ref() const noexcept {
+        ++m_refs;
+    }
+
+    void release() const noexcept {
+        if (--m_refs == 0) {
+            delete this;
+        }
+    }
+
+    size_t ref_count() const noexcept {
+        return m_refs;
+    }
+#endif // LUABIND_ATOMIC_REFCOUNT
+
+protected:
+    RefCounted() = default;
+
+    // copy has its own owners
+    RefCounted(const RefCounted&) noexcept
+        : Object() {}
+
+    RefCounted& operator=(const RefCounted&) noexcept {
+        return *this;
+    }
+
+private:
+#ifdef LUABIND_ATOMIC_REFCOUNT
+    mutable std::atomic<size_t> m_refs = 0;
+#else
+    mutable size_t m_refs = 0;
+#endif // LUABIND_ATOMIC_REFCOUNT
+};
+
+/**
+ * Smart pointer to the RefCounted object, intrusive alternative of std::shared_ptr.
+ * It is a single pointer and the object is passed to lua without separate control block.
+ */
+template <typename T>
+class ref_ptr {
+public:
+    ref_ptr() noexcept = default;
+
+    ref_ptr(std::nullptr_t) noexcept {}
+
+    explicit ref_ptr(T* p) noexcept
+        : m_ptr(p) {
+        if (m_ptr != nullptr) {
+            m_ptr->add_ref();
+        }
+    }
+
+    ref_ptr(const ref_ptr& other) noexcept
+        : ref_ptr(other.m_ptr) {}
+
+    template <typename U>
+        requires std::is_convertible_v<U*, T*>
+    ref_ptr(const ref_ptr<U>& other) noexcept
+        : ref_ptr(other.get()) {}
+
+    ref_ptr(ref_ptr&& other) noexcept
+        : m_ptr(std::exchange(other.m_ptr, nullptr)) {}
+
+    template <typename U>
+        requires std::is_convertible_v<U*, T*>
+    ref_ptr(ref_ptr<U>&& other) noexcept
+        : m_ptr(other.detach()) {}
+
+    ~ref_ptr() {
+        if (m_ptr != nullptr) {
+            m_ptr->release();
+        }
+    }
+
+    ref_ptr& operator=(ref_ptr other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void reset() noexcept {
+        ref_ptr().swap(*this);
+    }
+
+    void swap(ref_ptr& other) noexcept {
+        std::swap(m_ptr, other.m_ptr);
+    }
+
+    // Releases the ownership without decrementing the reference count.
+    [[nodiscard]] T* detach() noexcept {
+        return std::exchange(m_ptr, nullptr);
+    }
+
+    T* get() const noexcept {
+        return m_ptr;
+    }
+
+    T& operator*() const noexcept {
+        return *m_ptr;
+    }
+
+    T* operator->() const noexcept {
+        return m_ptr;
+    }
+
+    explicit operator bool() const noexcept {
+        return m_ptr != nullptr;
+    }
+
+    template <typename U>
+    bool operator==(const ref_ptr<U>& other) const noexcept {
+        return m_ptr == other.get();
+    }
+
+    bool operator==(std::nullptr_t) const noexcept {
+        return m_ptr == nullptr;
+    }
+
+private:
+    T* m_ptr = nullptr;
+};
+
+template <typename T, typename... Args>
+ref_ptr<T> make_ref(Args&&... args) {
+    static_assert(std::is_base_of_v<RefCounted, T>, "Type should be derived from luabind::RefCounted.");
+    return ref_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+} // namespace luabind
+
+#endif // LUABIND_REF_PTR_HPP
@@ -0,0 +1,290 @@
+#ifndef LUABIND_SIMD_HPP
+#define LUABIND_SIMD_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#ifndef LUABIND_NO_SIMD
+#if defined(__AVX__)
+#include <immintrin.h>
+#define LUABIND_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LUABIND_SIMD_SSE2
+#endif
+#endif // LUABIND_NO_SIMD
+
+/**
+ * Element-wise kernels over contiguous arrays of numbers.
+ * Floating point arrays are processed by the widest vector registers enabled at compile time, SSE2 or AVX,
+ * the remaining elements and the other types are processed by the scalar loop.
+ * Define LUABIND_NO_SIMD to use only the scalar loops.
+ */
+namespace luabind::simd {
+
+// Vector register of T elements, width is 1 if T is not vectorized.
+template <typename T>
+struct batch {
+    static constexpr size_t width = 1;
+};
+
+template <typename T>
+inline constexpr bool vectorized_v = batch<T>::width > 1;
+
+// Scalar operations, vector overloads follow for the enabled instruction set.
+template <typename V>
+V add(V a, V b) {
+    return a + b;
+}
+
+template <typename V>
+V mul(V a, V b) {
+    return a * b;
+}
+
+template <typename V>
+V min(V a, V b) {
+    return std::min(a, b);
+}
+
+template <typename V>
+V max(V a, V b) {
+    return std::max(a, b);
+}
+
+// a * b + c
+template <typename V>
+V fmadd(V a, V b, V c) {
+    return a * b + c;
+}
+
+#if defined(LUABIND_SIMD_AVX)
+
+template <>
+struct batch<float> {
+    using type = __m256;
+    static constexpr size_t width = 8;
+
+    static type load(const float* p) {
+        return _mm256_loadu_ps(p);
+    }
+
+    static void store(float* p, type v) {
+        _mm256_storeu_ps(p, v);
+    }
+
+    static type broadcast(float v) {
+        return _mm256_set1_ps(v);
+    }
+};
+
+template <>
+struct batch<double> {
+    using type = __m256d;
+    static constexpr size_t width = 4;
+
+    static type load(const double* p) {
+        return _mm256_loadu_pd(p);
+    }
+
+    static void store(double* p, type v) {
+        _mm256_storeu_pd(p, v);
+    }
+
+    static type broadcast(double v) {
+        return _mm256_set1_pd(v);
+    }
+};
+
+inline __m256 add(__m256 a, __m256 b) {
+    return _mm256_add_ps(a, b);
+}
+
+inline __m256d add(__m256d a, __m256d b) {
+    return _mm256_add_pd(a, b);
+}
+
+inline __m256 mul(__m256 a, __m256 b) {
+    return _mm256_mul_ps(a, b);
+}
+
+inline __m256d mul(__m256d a, __m256d b) {
+    return _mm256_mul_pd(a, b);
+}
+
+inline __m256 min(__m256 a, __m256 b) {
+    return _mm256_min_ps(a, b);
+}
+
+inline __m256d min(__m256d a, __m256d b) {
+    return _mm256_min_pd(a, b);
+}
+
+inline __m256 max(__m256 a, __m256 b) {
+    return _mm256_max_ps(a, b);
+}
+
+inline __m256d max(__m256d a, __m256d b) {
+    return _mm256_max_pd(a, b);
+}
+
+#ifdef __FMA__
+inline __m256 fmadd(__m256 a, __m256 b, __m256 c) {
+    return _mm256_fmadd_ps(a, b, c);
+}
+
+inline __m256d fmadd(__m256d a, __m256d b, __m256d c) {
+    return _mm256_fmadd_pd(a, b, c);
+}
+#else
+inline __m256 fmadd(__m256 a, __m256 b, __m256 c) {
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+}
+
+inline __m256d fmadd(__m256d a, __m256d b, __m256d c) {
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+}
+#endif // __FMA__
+
+#elif defined(LUABIND_SIMD_SSE2)
+
+template <>
+struct batch<float> {
+    using type = __m128;
+    static constexpr size_t width = 4;
+
+    static type load(const float* p) {
+        return _mm_loadu_ps(p);
+    }
+
+    static void store(float* p, type v) {
+        _mm_storeu_ps(p, v);
+    }
+
+    static type broadcast(float v) {
+        return _mm_set1_ps(v);
+    }
+};
+
+template <>
+struct batch<double> {
+    using type = __m128d;
+    static constexpr size_t width = 2;
+
+    static type load(const double* p) {
+        return _mm_loadu_pd(p);
+    }
+
+    static void store(double* p, type v) {
+        _mm_storeu_pd(p, v);
+    }
+
+    static type broadcast(double v) {
+        return _mm_set1_pd(v);
+    }
+};
+
+inline __m128 add(__m128 a, __m128 b) {
+    return _mm_add_ps(a, b);
+}
+
+inline __m128d add(__m128d a, __m128d b) {
+    return _mm_add_pd(a, b);
+}
+
+inline __m128 mul(__m128 a, __m128 b) {
+    return _mm_mul_ps(a, b);
+}
+
+inline __m128d mul(__m128d a, __m128d b) {
+    return _mm_mul_pd(a, b);
+}
+
+inline __m128 min(__m128 a, __m128 b) {
+    return _mm_min_ps(a, b);
+}
+
+inline __m128d min(__m128d a, __m128d b) {
+    return _mm_min_pd(a, b);
+}
+
+inline __m128 max(__m128 a, __m128 b) {
+    return _mm_max_ps(a, b);
+}
+
+inline __m128d max(__m128d a, __m128d b) {
+    return _mm_max_pd(a, b);
+}
+
+inline __m128 fmadd(__m128 a, __m128 b, __m128 c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+inline __m128d fmadd(__m128d a, __m128d b, __m128d c) {
+    return _mm_add_pd(_mm_mul_pd(a, b), c);
+}
+
+#endif // LUABIND_SIMD_AVX
+
+/**
+ * Returns the value of type V, the vector register or the scalar, with all elements equal to v.
+ * Kernels are generic lambdas called with both, so they use it for the captured scalars.
+ */
+template <typename V, typename T>
+V splat(T v) {
+    if constexpr (std::is_same_v<V, T>) {
+        return v;
+    } else {
+        return batch<T>::broadcast(v);
+    }
+}
+
+// dst[i] = op(src[i]...)
+template <typename T, typename Op, typename... Src>
+void transform(T* dst, size_t size, Op op, const Src*... src) {
+    size_t i = 0;
+    if constexpr (vectorized_v<T>) {
+        using B = batch<T>;
+        for (; i + B::width <= size; i += B::width) {
+            B::store(dst + i, op(B::load(src + i)...));
+        }
+    }
+    for (; i < size; ++i) {
+        dst[i] = op(src[i]...);
+    }
+}
+
+/**
+ * Accumulates step(acc, src[i]...) in each vector lane starting from init,
+ * then combines the lanes and the remaining elements.
+ * Each lane starts from init, so init should be neutral for combine, or combine should be idempotent.
+ */
+template <typename T, typename Step, typename Combine, typename... Src>
+T reduce(size_t size, T init, Step step, Combine combine, const Src*... src) {
+    size_t i = 0;
+    T result = init;
+    if constexpr (vectorized_v<T>) {
+        using B = batch<T>;
+        if (size >= B::width) {
+            typename B::type acc = B::broadcast(init);
+            for (; i + B::width <= size; i += B::width) {
+                acc = step(acc, B::load(src + i)...);
+            }
+            T lanes[B::width];
+            B::store(lanes, acc);
+            result = lanes[0];
+            for (size_t lane = 1; lane < B::width; ++lane) {
+                result = combine(result, lanes[lane]);
+            }
+        }
+    }
+    for (; i < size; ++i) {
+        result = step(result, src[i]...);
+    }
+    return result;
+}
+
+} // namespace luabind::simd
+
+#endif // LUABIND_SIMD_HPP
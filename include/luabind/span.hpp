@@ -0,0 +1,245 @@
+#ifndef LUABIND_SPAN_HPP
+#define LUABIND_SPAN_HPP
+
+#include "lua.hpp"
+
+#include "exception.hpp"
+#include "mirror.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+namespace luabind {
+
+/**
+ * User data of the view of the contiguous array of numbers, which memory is owned by C++.
+ * Lua accesses the elements in place, view[i] is 1-based and #view is the size of the span.
+ * The view doesn't keep the memory alive, unless it is pushed with its owner.
+ * Views of the memory with shorter lifetime should be invalidated, then they are empty.
+ */
+struct span_user_data {
+    void* data;
+    size_t size;
+    bool readonly;
+    // identifies the element type, see span_metatable<T>::key
+    const void* element_key;
+    std::shared_ptr<const void> owner;
+
+    /**
+     * Pushes the view of the span, owner is kept alive until the view is collected or invalidated.
+     * [-0, +1, m]
+     */
+    template <typename T>
+    static int to_lua(lua_State* L, std::span<T> span, std::shared_ptr<const void> owner = nullptr);
+
+    // Returns the view at the given index, or nullptr if it is not a view.
+    static span_user_data* from_lua(lua_State* L, int idx) {
+        if (lua_getmetatable(L, idx) == 0) {
+            return nullptr;
+        }
+        const bool valid = lua_rawgeti(L, -1, marker_idx) == LUA_TLIGHTUSERDATA && lua_touserdata(L, -1) == marker();
+        lua_pop(L, 2);
+        return valid ? static_cast<span_user_data*>(lua_touserdata(L, idx)) : nullptr;
+    }
+
+    // Detaches the view at the given index from the memory and releases the owner.
+    static void invalidate(lua_State* L, int idx) {
+        if (span_user_data* view = from_lua(L, idx); view != nullptr) {
+            view->data = nullptr;
+            view->size = 0;
+            view->owner.reset();
+        }
+    }
+
+    static constexpr int marker_idx = 1;
+
+    static void* marker() {
+        static char m = 0;
+        return &m;
+    }
+};
+
+// Element types of the spans, the character types other than char are not numbers.
+template <typename T>
+concept SpanElement = std::is_arithmetic_v<T> && !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char8_t> &&
+                      !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
+
+/**
+ * Metatable shared by the views of the same element type, metamethods access the memory directly.
+ * The metatable is hidden by __metatable, so the metamethods are called only with the views.
+ */
+template <typename T>
+struct span_metatable {
+    static_assert(SpanElement<T> && !std::is_const_v<T>);
+
+    static constexpr char key = 0;
+
+    // [-0, +1, m]
+    static void push(lua_State* L) {
+        if (lua_rawgetp(L, LUA_REGISTRYINDEX, &key) == LUA_TTABLE) [[likely]] {
+            return;
+        }
+        lua_pop(L, 1);
+        lua_createtable(L, 1, 5);
+        lua_pushlightuserdata(L, span_user_data::marker());
+        lua_rawseti(L, -2, span_user_data::marker_idx);
+        lua_pushcfunction(L, &index);
+        lua_setfield(L, -2, "__index");
+        lua_pushcfunction(L, &new_index);
+        lua_setfield(L, -2, "__newindex");
+        lua_pushcfunction(L, &length);
+        lua_setfield(L, -2, "__len");
+        lua_pushcfunction(L, &destruct);
+        lua_setfield(L, -2, "__gc");
+        lua_pushliteral(L, "span");
+        lua_setfield(L, -2, "__metatable");
+        lua_pushvalue(L, -1);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &key);
+    }
+
+    // Name of the element type for the error messages, typeid names are mangled.
+    static constexpr const char* element_name() {
+        if constexpr (std::is_same_v<T, bool>) {
+            return "bool";
+        } else if constexpr (std::is_same_v<T, char>) {
+            return "char";
+        } else if constexpr (std::is_same_v<T, signed char>) {
+            return "signed char";
+        } else if constexpr (std::is_same_v<T, unsigned char>) {
+            return "unsigned char";
+        } else if constexpr (std::is_same_v<T, short>) {
+            return "short";
+        } else if constexpr (std::is_same_v<T, unsigned short>) {
+            return "unsigned short";
+        } else if constexpr (std::is_same_v<T, int>) {
+            return "int";
+        } else if constexpr (std::is_same_v<T, unsigned int>) {
+            return "unsigned int";
+        } else if constexpr (std::is_same_v<T, long>) {
+            return "long";
+        } else if constexpr (std::is_same_v<T, unsigned long>) {
+            return "unsigned long";
+        } else if constexpr (std::is_same_v<T, long long>) {
+            return "long long";
+        } else if constexpr (std::is_same_v<T, unsigned long long>) {
+            return "unsigned long long";
+        } else if constexpr (std::is_same_v<T, float>) {
+            return "float";
+        } else if constexpr (std::is_same_v<T, double>) {
+            return "double";
+        } else if constexpr (std::is_same_v<T, long double>) {
+            return "long double";
+        } else {
+            return std::is_integral_v<T> ? "integer" : "number";
+        }
+    }
+
+    // Returns the view of T elements at the given index, or nullptr.
+    static span_user_data* from_lua(lua_State* L, int idx) {
+        span_user_data* view = span_user_data::from_lua(L, idx);
+        return view != nullptr && view->element_key == &key ? view : nullptr;
+    }
+
+private:
+    static T* element(lua_State* L, span_user_data* view) {
+        int is_integer = 0;
+        const lua_Integer i = lua_tointegerx(L, 2, &is_integer);
+        if (is_integer == 0 || i < 1 || static_cast<lua_Unsigned>(i) > view->size) {
+            return nullptr;
+        }
+        return static_cast<T*>(view->data) + (i - 1);
+    }
+
+    static int index(lua_State* L) {
+        auto* view = static_cast<span_user_data*>(lua_touserdata(L, 1));
+        if (const T* e = element(L, view); e != nullptr) [[likely]] {
+            return value_mirror<T>::to_lua(L, *e);
+        }
+        lua_pushnil(L);
+        return 1;
+    }
+
+    static int new_index(lua_State* L) {
+        auto* view = static_cast<span_user_data*>(lua_touserdata(L, 1));
+        if (view->readonly) [[unlikely]] {
+            return luaL_error(L, "Span is read only.");
+        }
+        T* e = element(L, view);
+        if (e == nullptr) [[unlikely]] {
+            return luaL_error(L,
+                              "Index %s is out of span range [1, %I].",
+                              luaL_tolstring(L, 2, nullptr),
+                              static_cast<lua_Integer>(view->size));
+        }
+        *e = value_mirror<T>::template from_lua<lua_error_policy>(L, 3);
+        return 0;
+    }
+
+    static int length(lua_State* L) {
+        auto* view = static_cast<span_user_data*>(lua_touserdata(L, 1));
+        lua_pushinteger(L, static_cast<lua_Integer>(view->size));
+        return 1;
+    }
+
+    static int destruct(lua_State* L) {
+        static_cast<span_user_data*>(lua_touserdata(L, 1))->~span_user_data();
+        return 0;
+    }
+};
+
+template <typename T>
+int span_user_data::to_lua(lua_State* L, std::span<T> span, std::shared_ptr<const void> owner) {
+    using element_type = std::remove_const_t<T>;
+    void* p = lua_newuserdatauv(L, sizeof(span_user_data), 0);
+    new (p) span_user_data {const_cast<element_type*>(span.data()),
+                            span.size(),
+                            std::is_const_v<T>,
+                            &span_metatable<element_type>::key,
+                            std::move(owner)};
+    span_metatable<element_type>::push(L);
+    lua_setmetatable(L, -2);
+    return 1;
+}
+
+/**
+ * Spans of numbers are passed to lua as views without copying,
+ * so the memory should outlive the view or the view should be invalidated, see span_user_data.
+ */
+template <typename T>
+    requires SpanElement<std::remove_const_t<T>>
+struct value_mirror<std::span<T>> {
+    using type = std::span<T>;
+    using element_type = std::remove_const_t<T>;
+
+    static int to_lua(lua_State* L, type v) {
+        return span_user_data::to_lua(L, v);
+    }
+
+    template <typename Policy = exception_policy>
+    static type from_lua(lua_State* L, int idx) {
+        span_user_data* view = span_metatable<element_type>::from_lua(L, idx);
+        if (view == nullptr) [[unlikely]] {
+            Policy::report(L,
+                           "Argument at %i has invalid type. Expecting span of '%s', but got '%s'.",
+                           idx,
+                           span_metatable<element_type>::element_name(),
+                           luaL_typename(L, idx));
+        }
+        if (!std::is_const_v<T> && view->readonly) [[unlikely]] {
+            Policy::report(L, "Argument at %i is a read only span.", idx);
+        }
+        return type(static_cast<T*>(view->data), view->size);
+    }
+};
+
+template <typename T>
+struct value_mirror<const std::span<T>> : value_mirror<std::span<T>> {};
+
+template <typename T>
+struct value_mirror<const std::span<T>&> : value_mirror<std::span<T>> {};
+
+} // namespace luabind
+
+#endif // LUABIND_SPAN_HPP
@@ -3,9 +3,16 @@
 
 #include "lua.hpp"
 #include "exception.hpp"
+#include "object.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <typeindex>
 #include <unordered_map>
@@ -17,15 +24,56 @@ enum class entry_type {
     none,
     function,
     property,
+    field,
+};
+
+class user_data;
+
+/**
+ * Defines how members of the class instances are resolved.
+ * index_function: __index is a C function which handles functions, properties, array access and custom fields.
+ * method_table: __index is a plain table of the bound functions, so lua resolves method lookups without
+ * calling into C. As lua doesn't pass the object to the __index of that table, the type switches to
+ * index_function, once it gets properties, array access or declared fields, also inherited ones.
+ * Custom fields can't be assigned to the objects of the types, which still use the method table.
+ */
+enum class binding_mode {
+    index_function,
+    method_table,
+};
+
+/**
+ * Typed C++ accessor of a property, called directly on the user data
+ * instead of calling the getter/setter closure through lua.
+ * Setters expect the new value at index 3 as in __newindex.
+ */
+struct native_accessor {
+    using function_t = int (*)(lua_State* L, user_data* ud, void* data);
+
+    function_t function = nullptr;
+    void* data = nullptr;
+
+    explicit operator bool() const {
+        return function != nullptr;
+    }
+
+    int operator()(lua_State* L, user_data* ud) const {
+        return function(L, ud, data);
+    }
 };
 
 struct entry {
     entry_type type;
+    // indices of the getter and setter in the function_store, 0 if there is none
     int getter;
     int setter;
+    // index of the user value, which keeps the declared field
+    int user_value = 0;
+    native_accessor native_getter;
+    native_accessor native_setter;
 
     bool has_setter() const {
-        return setter != 0;
+        return setter != 0 || native_setter;
     }
 
     static entry none() {
@@ -43,6 +91,61 @@ struct entry {
     static entry property(int getter, int setter) {
         return entry {.type = entry_type::property, .getter = getter, .setter = setter};
     }
+
+    static entry field(int user_value) {
+        return entry {.type = entry_type::field, .getter = 0, .setter = 0, .user_value = user_value};
+    }
+
+    static entry property(native_accessor getter, native_accessor setter) {
+        return entry {.type = entry_type::property,
+                      .getter = 0,
+                      .setter = 0,
+                      .native_getter = getter,
+                      .native_setter = setter};
+    }
+};
+
+/**
+ * Keeps the values bound by all types of the lua state: closures, method tables and member names.
+ * Values are stored in the array part of a table referenced from the registry.
+ * The table is given to the __index/__newindex functions as an upvalue,
+ * so the bound closure is fetched by a single lua_rawgeti in the calling state.
+ */
+class function_store {
+public:
+    explicit function_store(lua_State* L) {
+        lua_newtable(L);
+        _ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+
+    // [-0, +1, -]
+    void push(lua_State* L) const {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, _ref);
+    }
+
+    /**
+     * Moves the value at the top of the stack to the store.
+     * Returns index of the value, which is never 0.
+     * [-1, +0, m]
+     */
+    int add(lua_State* L) {
+        push(L);
+        lua_insert(L, -2);
+        lua_rawseti(L, -2, ++_size);
+        lua_pop(L, 1);
+        return _size;
+    }
+
+    // [-0, +1, -]
+    void get(lua_State* L, int idx) const {
+        push(L);
+        lua_rawgeti(L, -1, idx);
+        lua_remove(L, -2);
+    }
+
+private:
+    int _ref;
+    int _size = 0;
 };
 
 struct string_hash {
@@ -58,39 +161,194 @@ struct string_hash {
     }
 };
 
-struct type_info;
+struct pointer_hash {
+    [[nodiscard]] size_t operator()(const char* ptr) const {
+        // string contents are at least 8 bytes aligned, low bits carry little information
+        return std::hash<std::uintptr_t> {}(reinterpret_cast<std::uintptr_t>(ptr) >> 3);
+    }
+};
+
+/**
+ * Name of a member as it is stored in the member_table.
+ * Interned names are identified by address, others by contents.
+ */
+struct member_key {
+    std::string_view name;
+    bool interned;
 
-using index_function_t = int (*)(lua_State*, type_info*);
+    // [-0, +0, -]
+    static member_key from_lua(lua_State* L, int idx) {
+        size_t len;
+        const char* name = lua_tolstring(L, idx, &len);
+        // pushing the same short string again results in the same interned instance
+        const char* again = lua_pushlstring(L, name, len);
+        lua_pop(L, 1);
+        return member_key {.name = std::string_view {name, len}, .interned = name == again};
+    }
+};
+
+/**
+ * Member lookup table keyed by Lua strings.
+ * Lua interns short strings, so all equal short keys share the same address
+ * and can be found by pointer, without hashing the key bytes.
+ * Long strings are not interned and are looked up by their contents.
+ * Names should be kept alive by the owner of the table, otherwise the address can be reused.
+ */
+class member_table {
+public:
+    // [-0, +0, -]
+    const entry* find(lua_State* L, int key_idx) const {
+        size_t len;
+        const char* key = lua_tolstring(L, key_idx, &len);
+        auto it = _interned.find(key);
+        if (it != _interned.end()) {
+            return &it->second;
+        }
+        if (_long_names.empty()) [[likely]] {
+            return nullptr;
+        }
+        auto long_it = _long_names.find(std::string_view {key, len});
+        return long_it != _long_names.end() ? &long_it->second : nullptr;
+    }
+
+    const entry* find(const member_key& key) const {
+        if (key.interned) {
+            auto it = _interned.find(key.name.data());
+            return it != _interned.end() ? &it->second : nullptr;
+        }
+        auto it = _long_names.find(key.name);
+        return it != _long_names.end() ? &it->second : nullptr;
+    }
+
+    // Adds new entry with the given key, if it is not already added.
+    bool insert(const member_key& key, const entry& e) {
+        if (key.interned) {
+            return _interned.try_emplace(key.name.data(), e).second;
+        }
+        return _long_names.try_emplace(std::string {key.name}, e).second;
+    }
+
+    void assign(const member_key& key, const entry& e) {
+        if (key.interned) {
+            _interned.insert_or_assign(key.name.data(), e);
+        } else {
+            _long_names.insert_or_assign(std::string {key.name}, e);
+        }
+    }
+
+    template <typename Functor>
+    void for_each(Functor&& func) const {
+        for (const auto& [name, e] : _interned) {
+            func(member_key {.name = std::string_view {name}, .interned = true}, e);
+        }
+        for (const auto& [name, e] : _long_names) {
+            func(member_key {.name = std::string_view {name}, .interned = false}, e);
+        }
+    }
+
+private:
+    std::unordered_map<const char*, entry, pointer_hash> _interned;
+    std::unordered_map<std::string, entry, string_hash, std::equal_to<>> _long_names;
+};
+
+/**
+ * Pointer adjustment from the type to one of its bound ancestors or to itself.
+ * Dynamic casts are the ones which can't be done by offset, e.g. to virtual or ambiguous bases.
+ */
+struct upcast {
+    // type_slot of the ancestor
+    size_t target;
+    std::ptrdiff_t offset;
+    bool dynamic;
+};
 
 struct type_info {
     const std::string name;
     const std::vector<type_info*> bases;
-    index_function_t index;
-    index_function_t new_index;
+    // method_table types switch to index_function, when they get members, which need it
+    binding_mode mode;
+    // bound types directly derived from this one
+    std::vector<type_info*> derived;
 
+    // indices of the array accessors in the function_store
     int array_getter = 0;
     int array_setter = 0;
-    std::unordered_map<std::string, entry, string_hash, std::equal_to<>> entries;
-    lua_State* storage;
+    // members bound to this type
+    member_table entries;
+    // members bound to this type and inherited from the bases,
+    // so the lookup doesn't depend on the depth of the hierarchy
+    member_table members;
+    // functors used by the native property accessors
+    std::vector<std::shared_ptr<void>> accessors;
+    // store shared by all types of the lua state
+    function_store& store;
+    // index of the method table in the store, if the type is bound with binding_mode::method_table
+    int method_table = 0;
+    // __index and __newindex of binding_mode::index_function, set by class_
+    lua_CFunction index_function = nullptr;
+    lua_CFunction new_index_function = nullptr;
+    // registry reference of the metatable
+    int metatable = LUA_NOREF;
+    // offset of the luabind::Object subobject, unknown if Object is a virtual base
+    std::ptrdiff_t object_offset = 0;
+    bool dynamic_object = true;
+    // the type is a ValueType, user data points to the object itself instead of its luabind::Object subobject
+    bool value_type = false;
+    // destructs the value type object in place, nullptr if it is trivially destructible
+    void (*destructor)(void*) = nullptr;
+    /**
+     * Whether the metatable has __gc. Lua and C++ owned objects of trivially destructible value types have
+     * nothing to finalize, so __gc is added only with the first shared object of such type.
+     */
+    bool finalized = true;
+    // casts to the type itself and all of its bound ancestors
+    std::vector<upcast> upcasts;
+    // type_slot of the type
+    size_t slot = 0;
+    /**
+     * Pre and post order numbers of the type in the forest of the bound types, where each type is the child
+     * of its first base, so the ancestors along the first bases are found by the interval check.
+     * Other ancestors are found in the upcasts, if the type or any of its ancestors has several bases.
+     */
+    int pre_order = 0;
+    int post_order = 0;
+    bool multiple_bases = false;
+
+    /**
+     * User value of the last declared field. The custom table is always the 1st user value,
+     * fields declared by the type and its first base follow it.
+     */
+    int last_field = custom_table_idx;
+    // objects of the sealed type have no custom table, assigning unknown members is an error
+    bool sealed = false;
+    // objects pushed to lua several times are represented by the same user data, see type_storage::identity_cache
+    bool identity_cache = false;
+
+    // The metatables of luabind objects have a marker at this index, so foreign user data is not accepted.
+    static constexpr int metatable_marker_idx = 1;
+    static constexpr int custom_table_idx = 1;
 
     type_info(lua_State* L,
               std::string&& type_name,
               std::vector<type_info*>&& bases,
-              index_function_t index_functor,
-              index_function_t new_index_functor)
+              binding_mode mode,
+              function_store& store)
         : name(std::move(type_name))
         , bases(std::move(bases))
-        , index(index_functor)
-        , new_index(new_index_functor) {
+        , mode(mode)
+        , store(store) {
         int r = luaL_newmetatable(L, name.c_str());
         if (r == 0) {
             reportError("Type already exists.");
         }
-        storage = lua_newthread(L);
-        lua_checkstack(storage, 128);
-        lua_rawseti(L, -2, 1);
-
+        set_metatable_marker(L, lua_gettop(L));
+        lua_pushvalue(L, -1);
         lua_setglobal(L, name.c_str());
+        metatable = luaL_ref(L, LUA_REGISTRYINDEX);
+        if (mode == binding_mode::method_table) {
+            lua_newtable(L);
+            method_table = store.add(L);
+        }
         //  stack is clean
     }
 
@@ -98,109 +356,355 @@ struct type_info {
         // TODO add metatable cleanup
     }
 
+    // [-0, +1, -]
     void get_metatable(lua_State* L) const {
-        luaL_getmetatable(L, name.c_str());
+        lua_rawgeti(L, LUA_REGISTRYINDEX, metatable);
     }
 
-    std::string_view to_string_view(lua_State* L, int idx) {
-        size_t len;
-        const char* str = lua_tolstring(L, idx, &len);
-        return std::string_view {str, len};
+    // [-0, +1, -]
+    void get_method_table(lua_State* L) const {
+        store.get(L, method_table);
     }
 
-    // [-0, +0|+2, -]
-    entry get_entry(lua_State* L, int key_idx, bool setter) {
-        const auto name = to_string_view(L, key_idx);
-        auto it = entries.find(name);
-        if (it == entries.end()) {
+    /**
+     * Pushes the getter or setter of the member with the name at key_idx, if it is a closure.
+     * store_idx is the stack index of the function_store table, usually an upvalue of the caller.
+     * [-0, +0|+1, -]
+     */
+    entry get_entry(lua_State* L, int key_idx, bool setter, int store_idx) const {
+        const entry* e = members.find(L, key_idx);
+        if (e == nullptr) {
             return entry::none();
         }
-        const auto& e = it->second;
-        const int idx = setter ? e.setter : e.getter;
+        const int idx = setter ? e->setter : e->getter;
         if (idx != 0) {
-            lua_pushvalue(storage, idx);
-            lua_xmove(storage, L, 1);
+            lua_rawgeti(L, store_idx, idx);
         }
-        return e;
+        return *e;
+    }
+
+    /**
+     * Whether the member with the given name is bound to this type, the inherited members are not counted.
+     * [-0, +0, m]
+     */
+    bool has_entry(lua_State* L, const std::string_view name) const {
+        lua_pushlstring(L, name.data(), name.size());
+        const bool found = entries.find(L, -1) != nullptr;
+        lua_pop(L, 1);
+        return found;
     }
 
     /**
      * Sets the member function in the metatable of the class
      * The function is the value at the top of the stack
-     * The name of the function is the value just below the top
      * [-1, +0, -]
      */
-    void set_function(lua_State* L, std::string&& name) {
-        lua_xmove(L, storage, 1);
-        const int idx = lua_gettop(storage);
-        entries.try_emplace(std::move(name), entry::function(idx));
+    void set_function(lua_State* L, const std::string_view name) {
+        const auto key = add_name(L, name);
+        add_entry(L, key, entry::function(store.add(L)));
     }
 
     // [-1, +0, -]
-    void set_property_readonly(lua_State* L, std::string&& name) {
-        lua_xmove(L, storage, 1);
-        const int idx = lua_gettop(storage);
-        entries.try_emplace(std::move(name), entry::property(idx));
+    void set_property_readonly(lua_State* L, const std::string_view name) {
+        const auto key = add_name(L, name);
+        add_entry(L, key, entry::property(store.add(L)));
     }
 
     // [-2, +0, -]
-    void set_property(lua_State* L, std::string&& name) {
-        lua_xmove(L, storage, 2);
-        const int setter_idx = lua_gettop(storage);
-        const int getter_idx = setter_idx - 1;
-        entries.try_emplace(std::move(name), entry::property(getter_idx, setter_idx));
+    void set_property(lua_State* L, const std::string_view name) {
+        const auto key = add_name(L, name);
+        const int setter_idx = store.add(L);
+        const int getter_idx = store.add(L);
+        add_entry(L, key, entry::property(getter_idx, setter_idx));
+    }
+
+    // [-0, +0, -]
+    void set_property(lua_State* L,
+                      const std::string_view name,
+                      native_accessor getter,
+                      native_accessor setter = {}) {
+        const auto key = add_name(L, name);
+        add_entry(L, key, entry::property(getter, setter));
+    }
+
+    /**
+     * Declares the field, which is kept in the user value of the object.
+     * [-0, +0, -]
+     */
+    void set_field(lua_State* L, const std::string_view name) {
+        if (!derived.empty()) {
+            reportError("Fields of type '%s' should be declared before binding its derived types.",
+                        this->name.c_str());
+        }
+        const auto key = add_name(L, name);
+        add_entry(L, key, entry::field(last_field + 1));
+        ++last_field;
+    }
+
+    // Number of user values of the objects of this type.
+    int user_values() const {
+        return sealed && last_field == custom_table_idx ? 0 : last_field;
+    }
+
+    static void* metatable_marker() {
+        static char marker = 0;
+        return &marker;
+    }
+
+    // [-0, +0, -]
+    static void set_metatable_marker(lua_State* L, int metatable_idx) {
+        lua_pushlightuserdata(L, metatable_marker());
+        lua_rawseti(L, metatable_idx, metatable_marker_idx);
+    }
+
+    // Whether this type is the given one or its descendant, the types should be numbered, see type_storage::is_a.
+    bool is_a(const type_info* other) const {
+        if (other->pre_order <= pre_order && post_order <= other->post_order) {
+            return true;
+        }
+        if (!multiple_bases) {
+            return false;
+        }
+        return std::any_of(upcasts.begin(), upcasts.end(), [other](const upcast& c) {
+            return c.target == other->slot;
+        });
+    }
+
+    /**
+     * Converts the object of this type to the bound ancestor with the given type_slot by adding offsets.
+     * Returns nullptr if the conversion is not known statically and dynamic_cast should be used instead.
+     */
+    void* cast(void* object, size_t target) const {
+        if (dynamic_object) {
+            return nullptr;
+        }
+        for (const upcast& c : upcasts) {
+            if (c.target == target) {
+                return c.dynamic ? nullptr : reinterpret_cast<char*>(object) - object_offset + c.offset;
+            }
+        }
+        return nullptr;
+    }
+
+    // Adds casts to the base and its ancestors, base is at the given offset in this type.
+    void add_upcasts(const type_info& base, std::ptrdiff_t offset, bool dynamic) {
+        for (const upcast& c : base.upcasts) {
+            const upcast u {.target = c.target, .offset = offset + c.offset, .dynamic = dynamic || c.dynamic};
+            auto it = std::find_if(upcasts.begin(), upcasts.end(), [&u](const upcast& e) {
+                return e.target == u.target;
+            });
+            if (it == upcasts.end()) {
+                upcasts.push_back(u);
+            } else if (it->offset != u.offset || it->dynamic != u.dynamic) {
+                // ancestor is reachable by several paths
+                it->dynamic = true;
+            }
+        }
+    }
+
+    // Keeps the functor alive as long as the type and returns the pointer to it.
+    template <typename Functor>
+    void* store_accessor(Functor&& func) {
+        auto ptr = std::make_shared<std::remove_cvref_t<Functor>>(std::forward<Functor>(func));
+        accessors.push_back(ptr);
+        return ptr.get();
     }
 
     // [-1, +0, -]
     void set_array_getter(lua_State* L) {
-        lua_xmove(L, storage, 1);
-        array_getter = lua_gettop(storage);
+        array_getter = store.add(L);
+        use_index_function(L);
     }
 
     // [-2, +0, -]
     void set_array_access(lua_State* L) {
-        lua_xmove(L, storage, 2);
-        array_setter = lua_gettop(storage);
-        array_getter = array_setter - 1;
+        array_setter = store.add(L);
+        array_getter = store.add(L);
+        use_index_function(L);
+    }
+
+    // Sets the __index and __newindex C functions to the metatable.
+    // [-0, +0, -]
+    void set_index_functions(lua_State* L) const {
+        lua_checkstack(L, 4);
+        get_metatable(L);
+        lua_pushliteral(L, "__index");
+        store.push(L);
+        lua_pushvalue(L, -3);
+        lua_pushcclosure(L, index_function, 2);
+        lua_rawset(L, -3);
+        lua_pushliteral(L, "__newindex");
+        store.push(L);
+        lua_pushvalue(L, -3);
+        lua_pushcclosure(L, new_index_function, 2);
+        lua_rawset(L, -3);
+        lua_pop(L, 1);
+    }
+
+    /**
+     * Switches the type bound with a method table to the C functions, which resolve all kinds of members.
+     * The functions are set by class_, if the type is not registered completely yet.
+     * [-0, +0, -]
+     */
+    void use_index_function(lua_State* L) {
+        if (mode != binding_mode::method_table) {
+            return;
+        }
+        mode = binding_mode::index_function;
+        if (index_function != nullptr) {
+            set_index_functions(L);
+        }
     }
 
     // [-0, +0|+1, -]
-    int get_array_getter(lua_State* L) {
+    int get_array_getter(lua_State* L, int store_idx) const {
         if (array_getter == 0) {
             return LUA_TNIL;
         }
-        lua_pushvalue(storage, array_getter);
-        lua_xmove(storage, L, 1);
-        return lua_type(L, -1);
+        return lua_rawgeti(L, store_idx, array_getter);
     }
 
-    int get_array_setter(lua_State* L) {
+    // [-0, +0|+1, -]
+    int get_array_setter(lua_State* L, int store_idx) const {
         if (array_setter == 0) {
             return LUA_TNIL;
         }
-        lua_pushvalue(storage, array_setter);
-        lua_xmove(storage, L, 1);
-        return lua_type(L, -1);
+        return lua_rawgeti(L, store_idx, array_setter);
+    }
+
+    /**
+     * Builds the flattened member table from the members of the bases.
+     * Members of the type itself take precedence, then members of the bases in the declaration order.
+     */
+    void inherit_members(lua_State* L) {
+        for (type_info* base : bases) {
+            if (base->last_field != custom_table_idx) {
+                last_field = base->last_field;
+            }
+            base->derived.push_back(this);
+            base->members.for_each([this, L](const member_key& key, const entry& e) {
+                if (members.insert(key, e)) {
+                    set_method(L, key, e);
+                }
+            });
+        }
+    }
+
+private:
+    /**
+     * Adds the member name to the store, which keeps it alive as long as the lua state,
+     * so the address of the interned name can be used as a key.
+     * [-0, +0, m]
+     */
+    member_key add_name(lua_State* L, const std::string_view name) {
+        lua_checkstack(L, 3);
+        lua_pushlstring(L, name.data(), name.size());
+        const auto key = member_key::from_lua(L, -1);
+        store.add(L);
+        return key;
+    }
+
+    void add_entry(lua_State* L, const member_key& key, const entry& e) {
+        if (entries.insert(key, e)) {
+            update_member(L, key);
+        }
+    }
+
+    // Resolves the member with the given key and propagates it to the derived types.
+    void update_member(lua_State* L, const member_key& key) {
+        const entry* e = entries.find(key);
+        for (auto it = bases.begin(); e == nullptr && it != bases.end(); ++it) {
+            e = (*it)->members.find(key);
+        }
+        members.assign(key, *e);
+        set_method(L, key, *e);
+        for (type_info* child : derived) {
+            child->update_member(L, key);
+        }
+    }
+
+    // Mirrors the function in the method table, if the type has one, other members switch it to index_function.
+    void set_method(lua_State* L, const member_key& key, const entry& e) {
+        if (mode != binding_mode::method_table) {
+            return;
+        }
+        if (e.type != entry_type::function) {
+            use_index_function(L);
+            return;
+        }
+        lua_checkstack(L, 4);
+        store.push(L);
+        lua_rawgeti(L, -1, method_table);
+        lua_pushlstring(L, key.name.data(), key.name.size());
+        lua_rawgeti(L, -3, e.getter);
+        lua_rawset(L, -3);
+        lua_pop(L, 2);
     }
 };
 
+namespace detail {
+
+inline size_t next_type_slot() {
+    static std::atomic<size_t> counter = 0;
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename From, typename To>
+concept static_downcastable = requires(From* p) { static_cast<To*>(p); };
+
+// Offset of the non virtual Base subobject in Derived.
+template <typename Derived, typename Base>
+std::ptrdiff_t base_offset() {
+    // the object is never accessed, the address should only be non null and suitably aligned
+    auto* derived = reinterpret_cast<Derived*>(alignof(std::max_align_t) * 1024);
+    return reinterpret_cast<char*>(static_cast<Base*>(derived)) - reinterpret_cast<char*>(derived);
+}
+
+} // namespace detail
+
+/**
+ * Dense id of the type, assigned on the first use.
+ * Used to find type_info of the statically known type without hashing std::type_index.
+ */
+template <typename T>
+size_t type_slot() {
+    static const size_t slot = detail::next_type_slot();
+    return slot;
+}
+
+/**
+ * Per lua state context of the library, keeps the bound types.
+ * It is found by the light user data key in the registry, or, if LUABIND_USE_EXTRASPACE is defined,
+ * by the pointer in the extra space of the lua thread, which lua copies from the main thread to the new ones.
+ * Lua doesn't initialize the extra space, so in the latter case the state should be initialized by init
+ * right after its creation, before creating threads, and the extra space should not be used by anything else.
+ */
 class type_storage {
 private:
-    type_storage() = default;
+    explicit type_storage(lua_State* L)
+        : m_store(L) {}
 
 public:
     static type_storage& get_instance(lua_State* L) {
-        static const char* storage_name = "luabind::type_storage";
-        int r = lua_getfield(L, LUA_REGISTRYINDEX, storage_name);
+#ifdef LUABIND_USE_EXTRASPACE
+        type_storage* cached = extraspace(L);
+        if (cached != nullptr) [[likely]] {
+            return *cached;
+        }
+#endif // LUABIND_USE_EXTRASPACE
+        int r = lua_rawgetp(L, LUA_REGISTRYINDEX, &instance_key);
         if (r == LUA_TUSERDATA) {
             void* p = lua_touserdata(L, -1);
             auto ud = static_cast<type_storage**>(p);
             type_storage* instance = *ud;
             lua_pop(L, 1);
+#ifdef LUABIND_USE_EXTRASPACE
+            extraspace(L) = instance;
+#endif // LUABIND_USE_EXTRASPACE
             return *instance;
         }
         lua_pop(L, 1);
-        type_storage* instance = new type_storage;
+        type_storage* instance = new type_storage(L);
         void* p = lua_newuserdatauv(L, sizeof(void*), 0);
         auto ud = static_cast<type_storage**>(p);
         *ud = instance;
@@ -211,18 +715,35 @@ public:
             void* p = lua_touserdata(L, 1);
             auto ud = static_cast<type_storage**>(p);
             type_storage* instance = *ud;
+#ifdef LUABIND_USE_EXTRASPACE
+            // the memory of the closed state can be reused by the new one
+            extraspace(instance->m_main_thread) = nullptr;
+#endif // LUABIND_USE_EXTRASPACE
             delete instance;
             return 0;
         });
         lua_rawset(L, -3);
         lua_setmetatable(L, -2);
-        lua_setfield(L, LUA_REGISTRYINDEX, storage_name);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &instance_key);
+#ifdef LUABIND_USE_EXTRASPACE
+        instance->m_main_thread = main_thread(L);
+        extraspace(instance->m_main_thread) = instance;
+        extraspace(L) = instance;
+#endif // LUABIND_USE_EXTRASPACE
         return *instance;
     }
 
+    // Creates the instance of the new state, see luabind::init.
+    static void init(lua_State* L) {
+#ifdef LUABIND_USE_EXTRASPACE
+        extraspace(main_thread(L)) = nullptr;
+        extraspace(L) = nullptr;
+#endif // LUABIND_USE_EXTRASPACE
+        get_instance(L);
+    }
+
     template <typename Type, typename... Bases>
-    static type_info*
-    add_type_info(lua_State* L, std::string name, index_function_t index_functor, index_function_t new_index_functor) {
+    static type_info* add_type_info(lua_State* L, std::string name, binding_mode mode) {
         type_storage& instance = get_instance(L);
         const auto index = std::type_index(typeid(Type));
         auto it = instance.m_types.find(index);
@@ -232,18 +753,101 @@ public:
         std::vector<type_info*> bases;
         bases.reserve(sizeof...(Bases));
         (add_base_class<Bases>(instance, bases), ...);
-        auto r = instance.m_types.emplace(
-            index, type_info(L, std::move(name), std::move(bases), index_functor, new_index_functor));
-        return &(r.first->second);
+        // fields of the bases keep their user value slots, so only the first base can have them
+        for (size_t i = 1; i < bases.size(); ++i) {
+            if (bases[i]->last_field != type_info::custom_table_idx) {
+                reportError("Only the first base of type '%s' can have fields.", name.c_str());
+            }
+        }
+        auto r =
+            instance.m_types.emplace(index, type_info(L, std::move(name), std::move(bases), mode, instance.m_store));
+        type_info* info = &(r.first->second);
+        const size_t slot = type_slot<Type>();
+        if (instance.m_slots.size() <= slot) {
+            instance.m_slots.resize(slot + 1, nullptr);
+        }
+        instance.m_slots[slot] = info;
+        info->slot = slot;
+        info->upcasts.push_back(upcast {.target = slot, .offset = 0, .dynamic = false});
+        if constexpr (ValueType<Type>) {
+            info->dynamic_object = false;
+            info->value_type = true;
+            if constexpr (!std::is_trivially_destructible_v<Type>) {
+                info->destructor = [](void* object) { static_cast<Type*>(object)->~Type(); };
+            }
+        } else if constexpr (detail::static_downcastable<Object, Type>) {
+            info->object_offset = detail::base_offset<Type, Object>();
+            info->dynamic_object = false;
+        }
+        (add_base_upcasts<Type, Bases>(instance, *info), ...);
+        info->multiple_bases = info->bases.size() > 1 ||
+                               std::any_of(info->bases.begin(), info->bases.end(), [](const type_info* base) {
+                                   return base->multiple_bases;
+                               });
+        info->inherit_members(L);
+        instance.m_numbered = false;
+        return info;
     }
 
+    // Whether the type is the other one or its descendant, the types are numbered on the first check after changes.
+    static bool is_a(lua_State* L, const type_info* info, const type_info* other) {
+        type_storage& instance = get_instance(L);
+        if (!instance.m_numbered) [[unlikely]] {
+            instance.number_types();
+            instance.m_numbered = true;
+        }
+        return info->is_a(other);
+    }
+
+    // Registry reference of the metatable of the objects, which types are not bound.
+    static int& unbound_metatable(lua_State* L) {
+        return get_instance(L).m_unbound_metatable;
+    }
+
+    /**
+     * Pushes the table of the user data keyed by the object address, which is used for the types
+     * bound with identity cache. Values are weak, so the table doesn't keep the user data alive.
+     * [-0, +1, m]
+     */
+    static void push_identity_cache(lua_State* L) {
+        int& ref = get_instance(L).m_identity_cache;
+        if (ref != LUA_NOREF) [[likely]] {
+            lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+            return;
+        }
+        lua_newtable(L);
+        lua_createtable(L, 0, 1);
+        lua_pushliteral(L, "v");
+        lua_setfield(L, -2, "__mode");
+        lua_setmetatable(L, -2);
+        lua_pushvalue(L, -1);
+        ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+
+    // [-0, +1, -]
+    static void push_function_store(lua_State* L) {
+        get_instance(L).m_store.push(L);
+    }
+
+    /**
+     * Finds type_info of the dynamic type of the object.
+     * The typeid lookup is skipped if the bound static type is the dynamic one.
+     * Types can be bound without declaring their bases, so the derived types of the static one are not enough.
+     */
     template <typename T>
     static type_info* find_type_info(lua_State* L, const T* obj) {
-        type_info* info = find_type_info(L, std::type_index(typeid(*obj)));
-        if (info == nullptr) {
-            info = find_type_info<T>(L);
+        type_info* static_info = find_type_info<T>(L);
+        if constexpr (!std::is_polymorphic_v<T> || std::is_final_v<T>) {
+            if (static_info != nullptr) {
+                return static_info;
+            }
+        } else {
+            if (static_info != nullptr && typeid(*obj) == typeid(T)) {
+                return static_info;
+            }
         }
-        return info;
+        type_info* info = find_type_info(L, std::type_index(typeid(*obj)));
+        return info != nullptr ? info : static_info;
     }
 
     template <typename T>
@@ -254,7 +858,9 @@ public:
 
     template <typename T>
     static type_info* find_type_info(lua_State* L) {
-        return find_type_info(L, std::type_index(typeid(T)));
+        const size_t slot = type_slot<std::remove_cv_t<T>>();
+        const auto& slots = get_instance(L).m_slots;
+        return slot < slots.size() ? slots[slot] : nullptr;
     }
 
     static type_info* find_type_info(lua_State* L, std::type_index idx) {
@@ -274,11 +880,67 @@ private:
         bases.push_back(&(base_it->second));
     }
 
+    // Numbers all types in pre and post order, called lazily after registrations, so new types are covered.
+    void number_types() {
+        int counter = 0;
+        for (auto& [index, info] : m_types) {
+            if (info.bases.empty()) {
+                number_type(&info, counter);
+            }
+        }
+    }
+
+    static void number_type(type_info* info, int& counter) {
+        info->pre_order = counter++;
+        for (type_info* child : info->derived) {
+            if (child->bases.front() == info) {
+                number_type(child, counter);
+            }
+        }
+        info->post_order = counter++;
+    }
+
+    template <typename Type, typename Base>
+    static void add_base_upcasts(type_storage& instance, type_info& info) {
+        const type_info* base = instance.m_slots[type_slot<Base>()];
+        if constexpr (detail::static_downcastable<Base, Type>) {
+            info.add_upcasts(*base, detail::base_offset<Type, Base>(), false);
+        } else {
+            info.add_upcasts(*base, 0, true);
+        }
+    }
+
 public:
     using types = std::unordered_map<std::type_index, type_info>;
 
 private:
+#ifdef LUABIND_USE_EXTRASPACE
+    static type_storage*& extraspace(lua_State* L) {
+        return *static_cast<type_storage**>(lua_getextraspace(L));
+    }
+
+    static lua_State* main_thread(lua_State* L) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, LUA_RIDX_MAINTHREAD);
+        lua_State* main = lua_tothread(L, -1);
+        lua_pop(L, 1);
+        return main;
+    }
+#endif // LUABIND_USE_EXTRASPACE
+
+    static constexpr char instance_key = 0;
+
+    function_store m_store;
+#ifdef LUABIND_USE_EXTRASPACE
+    // the extra space of the main thread is cleared, when the state is closed
+    lua_State* m_main_thread = nullptr;
+#endif // LUABIND_USE_EXTRASPACE
+    int m_unbound_metatable = LUA_NOREF;
+    int m_identity_cache = LUA_NOREF;
+    // whether pre and post order numbers of the types are up to date
+    bool m_numbered = true;
     types m_types;
+    // bound types indexed by type_slot
+    std::vector<type_info*> m_slots;
 };
 
 } // namespace luabind
@@ -2,55 +2,116 @@
 #define LUABIND_USER_DATA
 
 #include "object.hpp"
+#include "ref_ptr.hpp"
 #include "type_storage.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <typeinfo>
 #include <utility>
 
 namespace luabind {
 
-enum class memory_lifetime { lua, cpp, shared };
+enum class memory_lifetime { lua, cpp, shared, intrusive };
 
+// Alignment of the lua user data memory, the same as LUAI_MAXALIGN of lua.
+inline constexpr size_t user_data_alignment =
+    std::max({alignof(lua_Number), alignof(double), alignof(void*), alignof(lua_Integer), alignof(long)});
+
+/**
+ * Header of the lua user data, which represents the object.
+ * It has no vtable, the lifetime is packed into the low bits of the type_info pointer
+ * and defines how the object is destructed, so the header takes only two pointers.
+ */
 class user_data {
 public:
-    Object* const object;
-    type_info* const info;
-    const memory_lifetime lifetime;
+    // luabind::Object subobject of the object, or the object itself if its type is a ValueType
+    void* const object;
+
+private:
+    std::uintptr_t m_info;
+
+    static constexpr std::uintptr_t lifetime_mask = 3;
+    static_assert(alignof(type_info) > lifetime_mask);
 
 protected:
-    user_data(Object* object, type_info* info, memory_lifetime lifetime)
+    user_data(void* object, type_info* info, memory_lifetime lifetime)
         : object(object)
-        , info(info)
-        , lifetime(lifetime) {}
+        , m_info(reinterpret_cast<std::uintptr_t>(info) | static_cast<std::uintptr_t>(lifetime)) {}
+
+    template <typename T>
+    static void* object_pointer(T* object) {
+        if constexpr (ValueType<T>) {
+            return object;
+        } else {
+            return static_cast<Object*>(object);
+        }
+    }
 
+    // Objects of the value types can be identified only by their type_info, so they should be bound.
     template <typename T>
-    user_data(lua_State* L, T* object, memory_lifetime lifetime)
-        : user_data(object, type_storage::find_type_info(L, object), lifetime) {}
+    static type_info* check_bound(type_info* info) {
+        if constexpr (ValueType<T>) {
+            if (info == nullptr) {
+                reportError("Value type '%s' should be bound before passing it to lua.", typeid(T).name());
+            }
+        }
+        return info;
+    }
+
+    ~user_data() = default;
 
 public:
-    virtual ~user_data() {
-        const_cast<Object*&>(object) = nullptr;
-    };
+    type_info* info() const {
+        return reinterpret_cast<type_info*>(m_info & ~lifetime_mask);
+    }
+
+    memory_lifetime lifetime() const {
+        return static_cast<memory_lifetime>(m_info & lifetime_mask);
+    }
 
+    // Destructs the object according to its lifetime, the object is nullptr afterwards.
+    void destroy();
+
+    /**
+     * Returns the user data at the given index, or nullptr if it is not created by luabind.
+     * Objects are recognized by the marker in their metatable.
+     * [-0, +0, -]
+     */
     static user_data* from_lua(lua_State* L, int idx) {
-        if (lua_islightuserdata(L, idx) == 1) {
+        if (lua_getmetatable(L, idx) == 0) {
             return nullptr;
         }
-        return static_cast<user_data*>(lua_touserdata(L, idx));
+        const bool valid = lua_rawgeti(L, -1, type_info::metatable_marker_idx) == LUA_TLIGHTUSERDATA &&
+                           lua_touserdata(L, -1) == type_info::metatable_marker();
+        lua_pop(L, 2);
+        return valid ? static_cast<user_data*>(lua_touserdata(L, idx)) : nullptr;
     }
 
 public:
-    static void* new_userdata(lua_State* L, size_t size) {
-        void* ud = lua_newuserdatauv(L, size, 1);
-        lua_newtable(L);
-        lua_setiuservalue(L, -2, 1);
-        return ud;
+    /**
+     * Allocates the user data with the user values for the custom table and the declared fields of the type.
+     * Custom table is not allocated here, it is created on the first get_custom_table call.
+     */
+    static void* new_userdata(lua_State* L, size_t size, const type_info* info) {
+        return lua_newuserdatauv(L, size, info != nullptr ? info->user_values() : type_info::custom_table_idx);
     }
 
+    // Pushes the metatable shared by the objects, which types are not bound.
     static void get_destructing_metatable(lua_State* L) {
+        int& ref = type_storage::unbound_metatable(L);
+        if (ref != LUA_NOREF) {
+            lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+            return;
+        }
         lua_newtable(L);
         int table_idx = lua_gettop(L);
         add_destructing_functions(L, table_idx);
+        type_info::set_metatable_marker(L, table_idx);
+        lua_pushvalue(L, table_idx);
+        ref = luaL_ref(L, LUA_REGISTRYINDEX);
     }
 
     static void add_destructing_functions(lua_State* L, int table_idx) {
@@ -59,18 +120,127 @@ public:
         lua_rawset(L, table_idx);
     }
 
+    /**
+     * Pushes the table with the custom fields of the object, creating it if necessary, and returns true.
+     * Objects of the sealed types have no custom table, then nothing is pushed and false is returned.
+     * Doesn't throw, so it can be called by lua_CFunctions without try region.
+     * [-0, +(0|1), m]
+     */
+    static bool try_get_custom_table(lua_State* L, int idx) {
+        const int type = lua_getiuservalue(L, idx, type_info::custom_table_idx);
+        if (type == LUA_TTABLE) {
+            return true;
+        }
+        lua_pop(L, 1);
+        const user_data* ud = from_lua(L, idx);
+        if (type == LUA_TNONE || (ud != nullptr && ud->info() != nullptr && ud->info()->sealed)) [[unlikely]] {
+            return false;
+        }
+        idx = lua_absindex(L, idx);
+        lua_newtable(L);
+        lua_pushvalue(L, -1);
+        lua_setiuservalue(L, idx, type_info::custom_table_idx);
+        return true;
+    }
+
+    /**
+     * Pushes the table with the custom fields of the object, creating it if necessary.
+     * Missing custom table is reported by luabind::error, so it should be called in a try region,
+     * see try_get_custom_table otherwise.
+     * [-0, +1, m]
+     */
     static void get_custom_table(lua_State* L, int idx) {
-        lua_getiuservalue(L, idx, 1);
+        if (try_get_custom_table(L, idx)) [[likely]] {
+            return;
+        }
+        const user_data* ud = from_lua(L, idx);
+        if (ud != nullptr && ud->info() != nullptr && ud->info()->sealed) {
+            reportError("Type '%s' is sealed, its objects have no custom table.", ud->info()->name.c_str());
+        }
+        reportError("User data has no user value for the custom table.");
+    }
+
+    /**
+     * Pushes the table with the custom fields of the object, or nil if it was not created yet.
+     * Returns the type of the pushed value.
+     * [-0, +1, -]
+     */
+    static int find_custom_table(lua_State* L, int idx) {
+        return lua_getiuservalue(L, idx, type_info::custom_table_idx);
     }
 
     static void set_custom_table(lua_State* L, int idx) {
-        lua_setiuservalue(L, idx, 1);
+        lua_setiuservalue(L, idx, type_info::custom_table_idx);
+    }
+
+    /**
+     * Removes the object from the identity cache, so it is represented by new user data when pushed again.
+     * Should be called if the object is destructed by C++ while lua still references it.
+     * [-0, +0, m]
+     */
+    template <typename T>
+    static void forget(lua_State* L, T* object) {
+        remove_from_identity_cache(L, object_pointer(object));
+    }
+
+protected:
+    /**
+     * Pushes the user data, which already represents the object, if there is one.
+     * Lua owned objects represent pointers to them as well.
+     * [-0, +0|+1, m]
+     */
+    static bool push_cached(lua_State* L, void* object, const type_info* info, memory_lifetime lifetime) {
+        type_storage::push_identity_cache(L);
+        if (lua_rawgetp(L, -1, object) == LUA_TUSERDATA) {
+            const auto* ud = static_cast<user_data*>(lua_touserdata(L, -1));
+            // lua owned and reference counting user data keep the object alive, so they can represent pointers too
+            const memory_lifetime cached = ud->lifetime();
+            const bool same_lifetime =
+                cached == lifetime || (lifetime == memory_lifetime::cpp &&
+                                       (cached == memory_lifetime::lua || cached == memory_lifetime::intrusive));
+            // the address can be reused by another object, or shared by the object and its first member
+            if (ud->object == object && ud->info() == info && same_lifetime) {
+                lua_remove(L, -2);
+                return true;
+            }
+        }
+        lua_pop(L, 2);
+        return false;
+    }
+
+    // [-0, +0, m]
+    static void add_to_identity_cache(lua_State* L, void* object) {
+        type_storage::push_identity_cache(L);
+        lua_pushvalue(L, -2);
+        lua_rawsetp(L, -2, object);
+        lua_pop(L, 1);
+    }
+
+    /**
+     * Removes the entry of the object, if it is the given user data or if ud is nullptr.
+     * Finalizer of the collected user data should not remove the entry added for the object afterwards.
+     * [-0, +0, m]
+     */
+    static void remove_from_identity_cache(lua_State* L, void* object, const user_data* ud = nullptr) {
+        type_storage::push_identity_cache(L);
+        lua_rawgetp(L, -1, object);
+        const bool remove = ud == nullptr || lua_touserdata(L, -1) == ud;
+        lua_pop(L, 1);
+        if (remove) {
+            lua_pushnil(L);
+            lua_rawsetp(L, -2, object);
+        }
+        lua_pop(L, 1);
     }
 
+public:
     static int destruct(lua_State* L) {
         user_data* ud = from_lua(L, -1);
-        if (ud->object != nullptr) {
-            ud->~user_data();
+        if (ud != nullptr && ud->object != nullptr) {
+            if (const type_info* info = ud->info(); info != nullptr && info->identity_cache) {
+                remove_from_identity_cache(L, ud->object, ud);
+            }
+            ud->destroy();
         }
         return 0;
     }
@@ -82,72 +252,198 @@ public:
     T data;
 
     template <typename... Args>
-    lua_user_data(lua_State* L, Args&&... args)
-        : user_data(nullptr, type_storage::find_type_info<T>(L), memory_lifetime::lua)
+    lua_user_data(type_info* info, Args&&... args)
+        : user_data(nullptr, info, memory_lifetime::lua)
         , data(std::forward<Args>(args)...) {
         // do not pass &data in user_data ctor, because in case of virtual inheritance
         // cast to Object* is implicitly dynamic_cast and needs fully initialized data
-        const_cast<Object*&>(object) = &data;
+        const_cast<void*&>(object) = object_pointer(&data);
     }
 
     template <typename... Args>
     static int to_lua(lua_State* L, Args&&... args) {
         static_assert(std::is_constructible_v<T, Args...>);
-        void* p = new_userdata(L, sizeof(lua_user_data));
-        lua_user_data* ud = new (p) lua_user_data(L, std::forward<Args>(args)...);
-        if (ud->info != nullptr) {
-            ud->info->get_metatable(L);
+        return to_lua_with_trailing(L, 0, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Pushes the object followed by the memory of the given size in the same user data,
+     * the memory starts right after the object, e.g. for the elements of the object of variable size.
+     */
+    template <typename... Args>
+    static int to_lua_with_trailing(lua_State* L, size_t trailing_size, Args&&... args) {
+        type_info* info = check_bound<T>(type_storage::find_type_info<T>(L));
+        if constexpr (alignof(T) <= user_data_alignment) {
+            // the header size is a multiple of the alignment, so the object follows it without padding
+            const size_t size = std::max(sizeof(lua_user_data), sizeof(user_data) + sizeof(T) + trailing_size);
+            void* p = new_userdata(L, size, info);
+            new (p) lua_user_data(info, std::forward<Args>(args)...);
+        } else {
+            over_aligned::to_lua(L, info, trailing_size, std::forward<Args>(args)...);
+        }
+        if (info != nullptr) {
+            info->get_metatable(L);
         } else {
             get_destructing_metatable(L);
         }
         lua_setmetatable(L, -2);
+        if (info != nullptr && info->identity_cache) {
+            // pointers to the lua owned object are pushed as the object itself
+            add_to_identity_cache(L, static_cast<user_data*>(lua_touserdata(L, -1))->object);
+        }
         return 1;
     }
+
+private:
+    /**
+     * Header of the over-aligned object. Lua aligns the user data only to user_data_alignment,
+     * so the memory is over-allocated and the object is placed at the aligned address after the header.
+     */
+    struct over_aligned : user_data {
+        over_aligned(void* object, type_info* info)
+            : user_data(object, info, memory_lifetime::lua) {}
+
+        static constexpr size_t size = sizeof(user_data) + sizeof(T) + alignof(T) - user_data_alignment;
+
+        template <typename... Args>
+        static void to_lua(lua_State* L, type_info* info, size_t trailing_size, Args&&... args) {
+            void* p = new_userdata(L, size + trailing_size, info);
+            const auto address = reinterpret_cast<std::uintptr_t>(p) + sizeof(user_data);
+            void* aligned = reinterpret_cast<void*>((address + alignof(T) - 1) & ~(alignof(T) - 1));
+            T* data = new (aligned) T(std::forward<Args>(args)...);
+            new (p) over_aligned(object_pointer(data), info);
+        }
+    };
 };
 
 template <typename T>
 struct cpp_user_data : user_data {
-    T* data;
-
-    cpp_user_data(lua_State* L, T* v)
-        : user_data(L, v, memory_lifetime::cpp)
-        , data(v) {}
+    cpp_user_data(T* v, type_info* info)
+        : user_data(object_pointer(v), info, memory_lifetime::cpp) {}
 
     static int to_lua(lua_State* L, T* v) {
-        void* p = new_userdata(L, sizeof(cpp_user_data));
-        cpp_user_data* ud = new (p) cpp_user_data(L, v);
-        if (ud->info != nullptr) {
-            ud->info->get_metatable(L);
+        type_info* info = check_bound<T>(type_storage::find_type_info(L, v));
+        const bool cached = info != nullptr && info->identity_cache;
+        if (cached && push_cached(L, object_pointer(v), info, memory_lifetime::cpp)) {
+            return 1;
+        }
+        void* p = new_userdata(L, sizeof(cpp_user_data), info);
+        new (p) cpp_user_data(v, info);
+        if (info != nullptr) {
+            info->get_metatable(L);
         } else {
             get_destructing_metatable(L);
         }
         lua_setmetatable(L, -2);
+        if (cached) {
+            add_to_identity_cache(L, object_pointer(v));
+        }
         return 1;
     }
 };
 
 struct shared_user_data : user_data {
-    std::shared_ptr<Object> data;
+    std::shared_ptr<void> data;
 
     template <typename T>
-    shared_user_data(lua_State* L, std::shared_ptr<T> v)
-        : user_data(L, v.get(), memory_lifetime::shared)
+    shared_user_data(std::shared_ptr<T> v, type_info* info)
+        : user_data(object_pointer(v.get()), info, memory_lifetime::shared)
         , data(std::move(v)) {}
 
     template <typename T>
     static int to_lua(lua_State* L, std::shared_ptr<T> v) {
-        void* p = new_userdata(L, sizeof(shared_user_data));
-        shared_user_data* ud = new (p) shared_user_data(L, std::move(v));
-        if (ud->info != nullptr) {
-            ud->info->get_metatable(L);
+        type_info* info = check_bound<T>(type_storage::find_type_info(L, v.get()));
+        void* object = object_pointer(v.get());
+        const bool cached = info != nullptr && info->identity_cache;
+        if (cached && push_cached(L, object, info, memory_lifetime::shared)) {
+            return 1;
+        }
+        void* p = new_userdata(L, sizeof(shared_user_data), info);
+        new (p) shared_user_data(std::move(v), info);
+        if (info != nullptr) {
+            info->get_metatable(L);
+            if (!info->finalized) [[unlikely]] {
+                // lua marks the object for finalization only if __gc is already there when metatable is set
+                add_destructing_functions(L, lua_gettop(L));
+                info->finalized = true;
+            }
         } else {
             get_destructing_metatable(L);
         }
         lua_setmetatable(L, -2);
+        if (cached) {
+            add_to_identity_cache(L, object);
+        }
         return 1;
     }
 };
 
+/**
+ * User data of the RefCounted object, which holds one reference to the object.
+ * The count is in the object, so the user data has only the header.
+ */
+struct intrusive_user_data : user_data {
+    template <typename T>
+    intrusive_user_data(T* v, type_info* info)
+        : user_data(object_pointer(v), info, memory_lifetime::intrusive) {
+        v->add_ref();
+    }
+
+    RefCounted* data() const {
+        return static_cast<RefCounted*>(static_cast<Object*>(object));
+    }
+
+    template <typename T>
+    static int to_lua(lua_State* L, T* v) {
+        static_assert(std::is_base_of_v<RefCounted, T>, "Type should be derived from luabind::RefCounted.");
+        if (v == nullptr) {
+            lua_pushnil(L);
+            return 1;
+        }
+        type_info* info = type_storage::find_type_info(L, v);
+        const bool cached = info != nullptr && info->identity_cache;
+        if (cached && push_cached(L, object_pointer(v), info, memory_lifetime::intrusive)) {
+            return 1;
+        }
+        void* p = new_userdata(L, sizeof(intrusive_user_data), info);
+        new (p) intrusive_user_data(v, info);
+        if (info != nullptr) {
+            info->get_metatable(L);
+        } else {
+            get_destructing_metatable(L);
+        }
+        lua_setmetatable(L, -2);
+        if (cached) {
+            add_to_identity_cache(L, object_pointer(v));
+        }
+        return 1;
+    }
+};
+
+inline void user_data::destroy() {
+    switch (lifetime()) {
+    case memory_lifetime::lua:
+        // the object lives in the same user data, virtual destructor destructs the whole object in place
+        if (const type_info* type = info(); type != nullptr && type->value_type) {
+            if (type->destructor != nullptr) {
+                type->destructor(object);
+            }
+        } else {
+            static_cast<Object*>(object)->~Object();
+        }
+        break;
+    case memory_lifetime::cpp:
+        break;
+    case memory_lifetime::shared:
+        static_cast<shared_user_data*>(this)->data.~shared_ptr();
+        break;
+    case memory_lifetime::intrusive:
+        static_cast<intrusive_user_data*>(this)->data()->release();
+        break;
+    }
+    const_cast<void*&>(object) = nullptr;
+}
+
 } // namespace luabind
 
 #endif // LUABIND_USER_DATA
@@ -5,30 +5,100 @@
 #include "mirror.hpp"
 #include "traits.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <exception>
+#include <functional>
+#include <limits>
 #include <type_traits>
 
 namespace luabind {
 
+// Mirror of the argument, which can report conversion errors with the given policy.
+template <typename Arg, typename Policy>
+concept PolicyMirror = requires(lua_State* L) { value_mirror<Arg>::template from_lua<Policy>(L, 1); };
+
+/**
+ * Argument, which can be converted with lua_error_policy.
+ * If lua error skips destructors, the argument and its converted value should be trivially destructible,
+ * as lua error raised while converting the next arguments would skip them.
+ */
+template <typename Arg>
+concept NothrowArg =
+    PolicyMirror<Arg, lua_error_policy> &&
+    (lua_error_unwinds ||
+     ((std::is_reference_v<Arg> || std::is_trivially_destructible_v<Arg>) &&
+      (std::is_reference_v<decltype(value_mirror<Arg>::from_lua(nullptr, 1))> ||
+       std::is_trivially_destructible_v<decltype(value_mirror<Arg>::from_lua(nullptr, 1))>)));
+
+/**
+ * Result, which can be pushed without exceptions.
+ * Mirrors of the user types can throw, e.g. when the value type is not bound or its copy throws.
+ */
+template <typename R>
+concept NothrowResult =
+    std::is_void_v<R> || std::is_arithmetic_v<std::remove_cvref_t<R>> ||
+    requires(lua_State* L, R&& r) { requires noexcept(value_mirror<R>::to_lua(L, std::forward<R>(r))); };
+
+/**
+ * Calls of the noexcept callables with arguments and result, which can be converted without exceptions,
+ * don't need a try region, conversion errors are reported by lua_error directly.
+ */
+template <typename Functor, bool Nothrow, typename R, typename... Args>
+constexpr bool nothrow_call_v = (Nothrow || (nothrow_calls && !throwing_callable_v<Functor>)) &&
+                                NothrowResult<R> && (NothrowArg<Args> && ...);
+
+template <bool Nothrow>
+using checked_policy_t = std::conditional_t<Nothrow, lua_error_policy, exception_policy>;
+
+template <bool Nothrow, bool Checked = true>
+using call_policy_t =
+    std::conditional_t<Checked, checked_policy_t<Nothrow>, unchecked_policy<checked_policy_t<Nothrow>>>;
+
+/**
+ * Tag to bind the function, which is called only from trusted code, without argument count and type checks.
+ * See LUABIND_CHECK_LEVEL.
+ */
+struct unchecked_t {
+    explicit unchecked_t() = default;
+};
+
+inline constexpr unchecked_t unchecked {};
+
+template <bool Unchecked>
+constexpr bool checked_call_v = LUABIND_CHECK_LEVEL >= 2 || (LUABIND_CHECK_LEVEL == 1 && !Unchecked);
+
+// Calls the callable and raises the lua error with the message of the exception it throws.
+template <typename Call>
+int protected_call(lua_State* L, Call&& call) {
+    try {
+        return call();
+    } catch (void*) {
+        // lua throws lua_longjmp* if compiled with C++ exceptions when yielding or reporting error
+        // rethrow to not interrupt lua logic flow in that case.
+        // assuming that normal code would not throw pointer
+        throw;
+    } catch (const luabind::error& e) {
+        lua_pushstring(L, e.what());
+    } catch (const std::exception& e) {
+        lua_pushstring(L, e.what());
+    } catch (...) {
+        lua_pushliteral(L, "Unknown exception while trying to call C function from Lua.");
+    }
+    lua_error(L); // [[noreturn]]
+    return 0;
+}
+
 template <typename CRTP>
 struct exception_safe_wrapper {
     static int safe_invoke(lua_State* L) {
-        try {
+        if constexpr (CRTP::nothrow) {
             return CRTP::invoke(L);
-        } catch (void*) {
-            // lua throws lua_longjmp* if compiled with C++ exceptions when yielding or reporting error
-            // rethrow to not interrupt lua logic flow in that case.
-            // assuming that normal code would not throw pointer
-            throw;
-        } catch (const luabind::error& e) {
-            lua_pushstring(L, e.what());
-        } catch (const std::exception& e) {
-            lua_pushstring(L, e.what());
-        } catch (...) {
-            lua_pushliteral(L, "Unknown exception while trying to call C function from Lua.");
+        } else {
+            return protected_call(L, [L]() { return CRTP::invoke(L); });
         }
-        lua_error(L); // [[noreturn]]
-        return 0;
     }
 };
 
@@ -36,18 +106,24 @@ template <typename Type, typename... Args>
 struct ctor_wrapper : exception_safe_wrapper<ctor_wrapper<Type, Args...>> {
     static_assert(std::conjunction_v<valid_lua_arg<Args>...>);
 
+    // the object is constructed in place of the user data of the bound type
+    static constexpr bool nothrow =
+        nothrow_call_v<Type, std::is_nothrow_constructible_v<Type, Args...>, void, Args...>;
+    using policy = call_policy_t<nothrow>;
+
     static int invoke(lua_State* L) {
         // 1st argument is the metatable
         int num_args = lua_gettop(L) - 1;
         if (num_args != sizeof...(Args)) {
-            reportError("Invalid number of arguments, should be %zu, but %i were given.", sizeof...(Args), num_args);
+            policy::report(
+                L, "Invalid number of arguments, should be %zu, but %i were given.", sizeof...(Args), num_args);
         }
         return indexed_call_helper(L, index_sequence<2, sizeof...(Args)> {});
     }
 
     template <size_t... Indices>
     static int indexed_call_helper(lua_State* L, std::index_sequence<Indices...>) {
-        return lua_user_data<Type>::to_lua(L, value_mirror<Args>::from_lua(L, Indices)...);
+        return lua_user_data<Type>::to_lua(L, value_mirror<Args>::template from_lua<policy>(L, Indices)...);
     }
 };
 
@@ -55,6 +131,9 @@ template <typename Type, typename... Args>
 struct shared_ctor_wrapper : exception_safe_wrapper<shared_ctor_wrapper<Type, Args...>> {
     static_assert(std::conjunction_v<valid_lua_arg<Args>...>);
 
+    // std::make_shared can throw
+    static constexpr bool nothrow = false;
+
     static int invoke(lua_State* L) {
         // 1st argument is the metatable
         int num_args = lua_gettop(L) - 1;
@@ -70,6 +149,29 @@ struct shared_ctor_wrapper : exception_safe_wrapper<shared_ctor_wrapper<Type, Ar
     }
 };
 
+template <typename Type, typename... Args>
+struct intrusive_ctor_wrapper : exception_safe_wrapper<intrusive_ctor_wrapper<Type, Args...>> {
+    static_assert(std::conjunction_v<valid_lua_arg<Args>...>);
+
+    // operator new can throw
+    static constexpr bool nothrow = false;
+
+    static int invoke(lua_State* L) {
+        // 1st argument is the metatable
+        int num_args = lua_gettop(L) - 1;
+        if (num_args != sizeof...(Args)) {
+            reportError("Invalid number of arguments, should be %zu, but %i were given.", sizeof...(Args), num_args);
+        }
+        return indexed_call_helper(L, index_sequence<2, sizeof...(Args)> {});
+    }
+
+    template <size_t... Indices>
+    static int indexed_call_helper(lua_State* L, std::index_sequence<Indices...>) {
+        auto object = make_ref<Type>(value_mirror<Args>::from_lua(L, Indices)...);
+        return intrusive_user_data::to_lua(L, object.get());
+    }
+};
+
 template <typename T>
 struct mem_fun_wrapper;
 
@@ -87,7 +189,17 @@ struct mem_fun_wrapper<R (T::*)(Args...)> {
 };
 
 template <typename R, typename T, typename... Args>
-struct mem_fun_wrapper<R (T::*)(Args...) noexcept> : mem_fun_wrapper<R (T::*)(Args...)> {};
+struct mem_fun_wrapper<R (T::*)(Args...) noexcept> {
+    using Ptr = R (T::*)(Args...) noexcept;
+    Ptr func;
+
+    mem_fun_wrapper(Ptr ptr)
+        : func(ptr) {}
+
+    R operator()(T* self, Args... args) noexcept {
+        return (self->*func)(args...);
+    }
+};
 
 template <typename R, typename T, typename... Args>
 struct mem_fun_wrapper<R (T::*)(Args...) const> {
@@ -103,43 +215,50 @@ struct mem_fun_wrapper<R (T::*)(Args...) const> {
 };
 
 template <typename R, typename T, typename... Args>
-struct mem_fun_wrapper<R (T::*)(Args...) const noexcept> : mem_fun_wrapper<R (T::*)(Args...) const> {};
+struct mem_fun_wrapper<R (T::*)(Args...) const noexcept> {
+    using Ptr = R (T::*)(Args...) const noexcept;
+    Ptr func;
+
+    mem_fun_wrapper(Ptr ptr)
+        : func(ptr) {}
 
-template <typename Functor, typename Signature, size_t ArgStart>
+    R operator()(const T* self, Args... args) noexcept {
+        return (self->*func)(args...);
+    }
+};
+
+template <typename Ptr>
+inline constexpr bool throwing_callable_v<mem_fun_wrapper<Ptr>> = throwing_callable_v<Ptr>;
+
+template <typename Functor, typename Signature, size_t ArgStart, bool Checked = true>
 struct invoker;
 
-template <typename Functor, size_t ArgStart>
-struct invoker<Functor, int(lua_State*), ArgStart> {
+template <typename Functor, size_t ArgStart, bool Checked>
+struct invoker<Functor, int(lua_State*), ArgStart, Checked> {
     static int invoke(lua_State* L, Functor& func) {
         return func(L);
     }
 };
 
-template <typename Functor, typename R, typename... Args, size_t ArgStart>
-struct invoker<Functor, R(Args...), ArgStart> {
+template <typename Functor, typename R, typename... Args, size_t ArgStart, bool Checked>
+struct invoker<Functor, R(Args...), ArgStart, Checked> {
+    static constexpr bool nothrow =
+        nothrow_call_v<Functor, std::is_nothrow_invocable_v<Functor&, Args...>, R, Args...>;
+    using policy = call_policy_t<nothrow, Checked>;
+
     static int invoke(lua_State* L, Functor& func) {
-        try {
+        if constexpr (nothrow) {
             return invoke_helper(L, func);
-        } catch (void*) {
-            // lua throws lua_longjmp* if compiled with C++ exceptions when yielding or reporting error
-            // rethrow to not interrupt lua logic flow in that case.
-            // assuming that normal code would not throw pointer
-            throw;
-        } catch (const luabind::error& e) {
-            lua_pushstring(L, e.what());
-        } catch (const std::exception& e) {
-            lua_pushstring(L, e.what());
-        } catch (...) {
-            lua_pushliteral(L, "Unknown exception while trying to call C function from Lua.");
+        } else {
+            return protected_call(L, [L, &func]() { return invoke_helper(L, func); });
         }
-        lua_error(L); // [[noreturn]]
-        return 0;
     }
 
     static int invoke_helper(lua_State* L, Functor& func) {
         const int num_args = lua_gettop(L) - (ArgStart - 1);
-        if (num_args != sizeof...(Args)) {
-            reportError("Invalid number of arguments, should be %zu, but %i were given.", sizeof...(Args), num_args);
+        if (policy::checked && num_args != sizeof...(Args)) {
+            policy::report(
+                L, "Invalid number of arguments, should be %zu, but %i were given.", sizeof...(Args), num_args);
         }
         return indexed_invoke_helper(L, func, index_sequence<ArgStart, sizeof...(Args)> {});
     }
@@ -147,15 +266,19 @@ struct invoker<Functor, R(Args...), ArgStart> {
     template <size_t... Indices>
     static int indexed_invoke_helper(lua_State* L, Functor& func, std::index_sequence<Indices...>) {
         if constexpr (std::is_same_v<R, void>) {
-            std::invoke(func, value_mirror<Args>::from_lua(L, Indices)...);
+            std::invoke(func, value_mirror<Args>::template from_lua<policy>(L, Indices)...);
             return 0;
         } else {
-            return value_mirror<R>::to_lua(L, std::invoke(func, value_mirror<Args>::from_lua(L, Indices)...));
+            return value_mirror<R>::to_lua(
+                L, std::invoke(func, value_mirror<Args>::template from_lua<policy>(L, Indices)...));
         }
     }
 };
 
-template <typename Functor, size_t ArgStart = 1>
+template <typename Functor, size_t ArgStart, bool Checked>
+struct erased_functor_wrapper;
+
+template <typename Functor, size_t ArgStart = 1, bool Checked = true>
 struct functor_wrapper {
     using Signature = signature_t<Functor>;
 
@@ -163,10 +286,10 @@ struct functor_wrapper {
         const int func_idx = lua_upvalueindex(1);
         if constexpr (is_function_ptr_v<Functor>) {
             Functor func = reinterpret_cast<Functor>(lua_touserdata(L, func_idx));
-            return invoker<Functor, Signature, ArgStart>::invoke(L, func);
+            return invoker<Functor, Signature, ArgStart, Checked>::invoke(L, func);
         } else {
             Functor* func = static_cast<Functor*>(lua_touserdata(L, func_idx));
-            return invoker<Functor, Signature, ArgStart>::invoke(L, *func);
+            return invoker<Functor, Signature, ArgStart, Checked>::invoke(L, *func);
         }
     }
 
@@ -179,50 +302,331 @@ struct functor_wrapper {
             lua_pushlightuserdata(L, reinterpret_cast<void*>(func));
             lua_pushcclosure(L, &invoke, 1); // create closure with user data as upvalue
         } else {
-            void* ud = lua_newuserdatauv(L, sizeof(Functor), 0);
-            new (ud) Functor(std::move(func)); // std::function as user data
-
-            if constexpr (!std::is_trivially_destructible_v<Functor>) {
-                lua_newtable(L);
-                lua_pushliteral(L, "__gc");
-                lua_pushcfunction(L, [](lua_State* L) -> int {
-                    void* ud = lua_touserdata(L, 1);
-                    Functor* storage = static_cast<Functor*>(ud);
-                    storage->~Functor();
-                    return 0;
-                });
-                lua_rawset(L, -3); // set __gc in table
-                lua_setmetatable(L, -2); // set table as metatable for user data
-            }
-            lua_pushcclosure(L, &invoke, 1); // create closure with user data as upvalue
+            erased_functor_wrapper<Functor, ArgStart, Checked>::to_lua(L, std::move(func));
         }
     }
 };
 
-template <typename Functor, size_t ArgStart = 1>
+/**
+ * Callable object erased to the trampoline of its signature.
+ * The argument conversion and the call code is generated once per signature and shared by all callable objects
+ * with that signature, only the tiny trampoline is generated per callable type.
+ */
+template <typename Signature, bool Nothrow, bool Throwing = false>
+struct erased_functor;
+
+template <typename Signature, bool Nothrow, bool Throwing>
+inline constexpr bool throwing_callable_v<erased_functor<Signature, Nothrow, Throwing>> = Throwing;
+
+template <typename Functor, typename Signature>
+constexpr bool nothrow_invocable_v = false;
+
+template <typename Functor, typename R, typename... Args>
+constexpr bool nothrow_invocable_v<Functor, R(Args...)> = std::is_nothrow_invocable_v<Functor&, Args...>;
+
+template <typename R, typename... Args, bool Nothrow, bool Throwing>
+struct erased_functor<R(Args...), Nothrow, Throwing> {
+    using trampoline_type = R (*)(void*, Args...) noexcept(Nothrow);
+
+    trampoline_type trampoline;
+    void* object;
+
+    R operator()(Args... args) const noexcept(Nothrow) {
+        return trampoline(object, std::forward<Args>(args)...);
+    }
+
+    template <typename Functor>
+    static R call(void* object, Args... args) noexcept(Nothrow) {
+        return std::invoke(*static_cast<Functor*>(object), std::forward<Args>(args)...);
+    }
+};
+
+template <typename Functor, size_t ArgStart, bool Checked>
+struct erased_functor_wrapper {
+    using Signature = signature_t<Functor>;
+    using Erased = erased_functor<Signature, nothrow_invocable_v<Functor, Signature>, throwing_callable_v<Functor>>;
+
+    /**
+     * The callable object is placed after the erased functor in the same user data.
+     * Lua aligns the user data only to user_data_alignment, so the memory is over-allocated for the over-aligned
+     * callable objects and they are placed at the aligned address, as lua_user_data does.
+     */
+    static constexpr size_t padding =
+        alignof(Functor) > user_data_alignment ? alignof(Functor) - user_data_alignment : 0;
+
+    static void to_lua(lua_State* L, Functor&& func) {
+        void* ud = lua_newuserdatauv(L, sizeof(Erased) + padding + sizeof(Functor), 0);
+        const auto address = reinterpret_cast<std::uintptr_t>(ud) + sizeof(Erased);
+        void* object = reinterpret_cast<void*>((address + alignof(Functor) - 1) & ~(alignof(Functor) - 1));
+        new (object) Functor(std::move(func));
+        new (ud) Erased {&Erased::template call<Functor>, object};
+
+        if constexpr (!std::is_trivially_destructible_v<Functor>) {
+            lua_newtable(L);
+            lua_pushliteral(L, "__gc");
+            lua_pushcfunction(L, [](lua_State* L) -> int {
+                auto* erased = static_cast<Erased*>(lua_touserdata(L, 1));
+                static_cast<Functor*>(erased->object)->~Functor();
+                return 0;
+            });
+            lua_rawset(L, -3); // set __gc in table
+            lua_setmetatable(L, -2); // set table as metatable for user data
+        }
+        // invoke is shared by all callable objects with the same signature
+        lua_pushcclosure(L, &functor_wrapper<Erased, ArgStart, Checked>::invoke, 1);
+    }
+};
+
+/**
+ * Stateless callable for the function given as template argument.
+ * The call target is known at compile time, so it can be inlined into the generated lua_CFunction.
+ */
+template <auto Func, typename Signature = signature_t<decltype(Func)>>
+struct static_function;
+
+template <auto Func, typename R, typename... Args>
+struct static_function<Func, R(Args...)> {
+    R operator()(Args... args) const noexcept(std::is_nothrow_invocable_v<decltype(Func), Args...>) {
+        return std::invoke(Func, std::forward<Args>(args)...);
+    }
+};
+
+template <auto Func, typename Signature>
+inline constexpr bool throwing_callable_v<static_function<Func, Signature>> = throwing_callable_v<decltype(Func)>;
+
+template <auto Func, size_t ArgStart = 1, bool Checked = true>
+struct static_functor_wrapper {
+    using Functor = static_function<Func>;
+    using Signature = signature_t<decltype(Func)>;
+
+    static int invoke(lua_State* L) {
+        Functor func;
+        return invoker<Functor, Signature, ArgStart, Checked>::invoke(L, func);
+    }
+};
+
+// Pushes a dedicated lua_CFunction without upvalues for the function given as template argument.
+template <auto Func, size_t ArgStart = 1, bool Checked = true>
+void static_functor_to_lua(lua_State* L) {
+    using F = decltype(Func);
+    if constexpr (is_lua_c_function_v<F>) {
+        lua_pushcfunction(L, static_cast<lua_CFunction>(Func));
+    } else {
+        using wrapper = static_functor_wrapper<Func, ArgStart, Checked>;
+        lua_pushcfunction(L, &wrapper::invoke);
+    }
+}
+
+template <typename Functor, size_t ArgStart = 1, bool Checked = true>
 void functor_to_lua(lua_State* L, Functor&& func) {
     using F = std::remove_cvref_t<Functor>;
     if constexpr (is_lua_c_function_v<F>) {
         lua_pushcfunction(L, static_cast<lua_CFunction>(func));
     } else if constexpr (std::is_member_function_pointer_v<F>) {
-        functor_to_lua(L, mem_fun_wrapper<F>(func));
+        functor_to_lua<mem_fun_wrapper<F>, ArgStart, Checked>(L, mem_fun_wrapper<F>(func));
     } else if (is_function_ptr_v<F>) {
-        functor_wrapper<F, ArgStart>::to_lua(L, func);
+        functor_wrapper<F, ArgStart, Checked>::to_lua(L, func);
     } else if constexpr (stateless_lambda_v<F>) {
         auto fptr = static_cast<lambda_convertible_t<F>>(func);
-        functor_wrapper<lambda_convertible_t<F>, ArgStart>::to_lua(L, fptr);
+        functor_wrapper<lambda_convertible_t<F>, ArgStart, Checked>::to_lua(L, fptr);
     } else if constexpr (callable_object_v<F>) {
-        functor_wrapper<F, ArgStart>::to_lua(L, std::forward<Functor>(func));
+        functor_wrapper<F, ArgStart, Checked>::to_lua(L, std::forward<Functor>(func));
     } else {
         static_assert("Unsupported function type.");
     }
 }
 
-template <typename Functor>
+template <typename Functor, bool Checked = true>
 void class_functor_to_lua(lua_State* L, Functor&& func) {
-    functor_to_lua<Functor, 2>(L, std::forward<Functor>(func));
+    functor_to_lua<Functor, 2, Checked>(L, std::forward<Functor>(func));
 }
 
+template <typename Self, typename Policy = exception_policy>
+decltype(auto) self_from_user_data(lua_State* L, user_data* ud) {
+    using T = std::remove_reference_t<std::remove_pointer_t<Self>>;
+    if constexpr (std::is_pointer_v<Self>) {
+        return value_mirror<T*>::template from_user_data<Policy>(L, ud, 1);
+    } else {
+        return *value_mirror<T*>::template from_user_data<Policy>(L, ud, 1);
+    }
+}
+
+template <typename Functor, size_t Arity>
+concept NativeAccessor = !is_lua_c_function_v<Functor> && !is_lua_c_lambda_v<Functor> &&
+                         arity_v<Functor> == Arity && std::is_class_v<strip_t<first_arg_t<Functor>>> &&
+                         (std::is_pointer_v<first_arg_t<Functor>> || std::is_reference_v<first_arg_t<Functor>>);
+
+template <typename Getter>
+struct property_getter {
+    using self_type = first_arg_t<Getter>;
+    using result_type = std::invoke_result_t<Getter&, self_type>;
+
+    static constexpr bool nothrow =
+        nothrow_call_v<Getter, std::is_nothrow_invocable_v<Getter&, self_type>, result_type>;
+
+    static int invoke(lua_State* L, user_data* ud, void* data) {
+        Getter& getter = *static_cast<Getter*>(data);
+        auto call = [&]() {
+            using policy = call_policy_t<nothrow>;
+            return value_mirror<result_type>::to_lua(
+                L, std::invoke(getter, self_from_user_data<self_type, policy>(L, ud)));
+        };
+        if constexpr (nothrow) {
+            return call();
+        } else {
+            return protected_call(L, call);
+        }
+    }
+};
+
+template <typename Setter>
+struct property_setter {
+    using self_type = first_arg_t<Setter>;
+    using value_type = function_second_arg_t<signature_t<Setter>>;
+
+    static constexpr bool nothrow =
+        nothrow_call_v<Setter, std::is_nothrow_invocable_v<Setter&, self_type, value_type>, void, value_type>;
+
+    static int invoke(lua_State* L, user_data* ud, void* data) {
+        Setter& setter = *static_cast<Setter*>(data);
+        auto call = [&]() {
+            using policy = call_policy_t<nothrow>;
+            // the new value is the 3rd argument of __newindex
+            std::invoke(setter,
+                        self_from_user_data<self_type, policy>(L, ud),
+                        value_mirror<value_type>::template from_lua<policy>(L, 3));
+            return 0;
+        };
+        if constexpr (nothrow) {
+            return call();
+        } else {
+            return protected_call(L, call);
+        }
+    }
+};
+
+/**
+ * Bulk companions of the typed array accessors, which convert the range of elements in one call,
+ * instead of calling the accessor closure through __index for each element.
+ * The accessor is kept by the type_info and passed to the closures as light user data upvalue.
+ */
+// Range functions are called as methods, so the object is counted as the first argument.
+template <typename Policy>
+void check_range_args(lua_State* L, int expected) {
+    const int num_args = lua_gettop(L);
+    if (num_args != expected) [[unlikely]] {
+        Policy::report(L, "Invalid number of arguments, should be %i, but %i were given.", expected, num_args);
+    }
+}
+
+template <typename Getter, typename Signature = signature_t<Getter>>
+struct array_range_getter;
+
+template <typename Getter, typename R, typename Self, typename Index>
+struct array_range_getter<Getter, R(Self, Index)> {
+    static constexpr bool nothrow = nothrow_call_v<Getter, std::is_nothrow_invocable_v<Getter&, Self, Index>, R>;
+    using policy = call_policy_t<nothrow>;
+
+    // obj:getRange(first, last) returns the table with the elements [first, last)
+    static int get_range(lua_State* L) {
+        Getter& getter = *static_cast<Getter*>(lua_touserdata(L, lua_upvalueindex(1)));
+        auto call = [&]() {
+            check_range_args<policy>(L, 3);
+            decltype(auto) self = value_mirror<Self>::template from_lua<policy>(L, 1);
+            const auto first = value_mirror<lua_Integer>::template from_lua<policy>(L, 2);
+            const auto last = value_mirror<lua_Integer>::template from_lua<policy>(L, 3);
+            // the difference is computed without overflow, the table size is limited by int
+            const lua_Unsigned size =
+                last > first ? static_cast<lua_Unsigned>(last) - static_cast<lua_Unsigned>(first) : 0;
+            if (size > static_cast<lua_Unsigned>(std::numeric_limits<int>::max())) [[unlikely]] {
+                policy::report(L,
+                               "Range [%lli, %lli) is too large.",
+                               static_cast<long long>(first),
+                               static_cast<long long>(last));
+            }
+            lua_createtable(L, static_cast<int>(size), 0);
+            lua_Integer n = 0;
+            for (lua_Integer i = first; i < last; ++i) {
+                value_mirror<R>::to_lua(L, std::invoke(getter, self, static_cast<Index>(i)));
+                lua_rawseti(L, -2, ++n);
+            }
+            return 1;
+        };
+        if constexpr (nothrow) {
+            return call();
+        } else {
+            return protected_call(L, call);
+        }
+    }
+};
+
+template <typename Setter, typename Signature = signature_t<Setter>>
+struct array_range_setter;
+
+template <typename Setter, typename R, typename Self, typename Index, typename Value>
+struct array_range_setter<Setter, R(Self, Index, Value)> {
+    static constexpr bool nothrow =
+        nothrow_call_v<Setter, std::is_nothrow_invocable_v<Setter&, Self, Index, Value>, void, Value>;
+    using policy = call_policy_t<nothrow>;
+
+    /**
+     * obj:setRange(first, table) assigns the table elements to [first, first + #table)
+     * Elements are converted and assigned one by one, so the elements before the invalid one stay assigned.
+     */
+    static int set_range(lua_State* L) {
+        Setter& setter = *static_cast<Setter*>(lua_touserdata(L, lua_upvalueindex(1)));
+        auto call = [&]() {
+            check_range_args<policy>(L, 3);
+            decltype(auto) self = value_mirror<Self>::template from_lua<policy>(L, 1);
+            const auto first = value_mirror<lua_Integer>::template from_lua<policy>(L, 2);
+            if (lua_type(L, 3) != LUA_TTABLE) [[unlikely]] {
+                policy::report(L,
+                               "Argument at 3 has invalid type. Expecting 'table', but got '%s'.",
+                               lua_typename(L, lua_type(L, 3)));
+            }
+            const auto count = static_cast<lua_Integer>(lua_rawlen(L, 3));
+            for (lua_Integer n = 1; n <= count; ++n) {
+                lua_rawgeti(L, 3, n);
+                std::invoke(setter,
+                            self,
+                            static_cast<Index>(first + n - 1),
+                            element_from_lua<Value, policy>(L, 3, -1, [n](char* buffer, size_t size) {
+                                std::snprintf(buffer, size, "element %lli", static_cast<long long>(n));
+                            }));
+                lua_pop(L, 1);
+            }
+            return 0;
+        };
+        if constexpr (nothrow) {
+            return call();
+        } else {
+            return protected_call(L, call);
+        }
+    }
+
+    // obj:fillRange(first, last, value) assigns the value to the elements [first, last)
+    static int fill_range(lua_State* L) {
+        Setter& setter = *static_cast<Setter*>(lua_touserdata(L, lua_upvalueindex(1)));
+        auto call = [&]() {
+            check_range_args<policy>(L, 4);
+            decltype(auto) self = value_mirror<Self>::template from_lua<policy>(L, 1);
+            const auto first = value_mirror<lua_Integer>::template from_lua<policy>(L, 2);
+            const auto last = value_mirror<lua_Integer>::template from_lua<policy>(L, 3);
+            // the value is converted once
+            decltype(auto) value = value_mirror<Value>::template from_lua<policy>(L, 4);
+            for (lua_Integer i = first; i < last; ++i) {
+                std::invoke(setter, self, static_cast<Index>(i), value);
+            }
+            return 0;
+        };
+        if constexpr (nothrow) {
+            return call();
+        } else {
+            return protected_call(L, call);
+        }
+    }
+};
+
 } // namespace luabind
 
 #endif // LUABIND_WRAPPER_HPP
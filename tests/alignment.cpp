@@ -0,0 +1,102 @@
+#include "lua_test.hpp"
+
+#include <cstdint>
+#include <string>
+
+// 8 floats, as loaded by a single AVX instruction
+struct alignas(32) Avx final {
+    float v[8] = {};
+
+    Avx() = default;
+    Avx(float x) {
+        for (float& f : v) {
+            f = x;
+        }
+    }
+
+    float sum() const {
+        float r = 0;
+        for (float f : v) {
+            r += f;
+        }
+        return r;
+    }
+};
+
+struct alignas(64) CacheLine : luabind::Object {
+    char tag = 0;
+    alignas(32) Avx avx;
+
+    CacheLine() = default;
+    CacheLine(float x)
+        : avx(x) {}
+};
+
+template <typename T>
+bool isAligned(const T* p) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignof(T) == 0;
+}
+
+class AlignmentTest : public LuaTest {
+protected:
+    void SetUp() override {
+        const int top = lua_gettop(L);
+        luabind::class_<Avx>(L, "Avx").constructor<float>("new").function("sum", &Avx::sum);
+        luabind::class_<CacheLine>(L, "CacheLine").constructor<float>("new").function(
+            "sum", [](const CacheLine& self) { return self.avx.sum(); });
+        luabind::function(L, "aligned", [](const Avx* avx, const CacheLine* line) {
+            return isAligned(avx) && isAligned(line) && isAligned(&line->avx);
+        });
+
+        EXPECT_EQ(lua_gettop(L), top);
+    }
+};
+
+TEST_F(AlignmentTest, OverAlignedObjects) {
+    static_assert(alignof(Avx) == 32 && alignof(CacheLine) == 64);
+    static_assert(alignof(Avx) > luabind::user_data_alignment);
+
+    EXPECT_TRUE(runWithResult<bool>(R"--(
+        local r = true
+        local objects = {}
+        for i = 1, 100 do
+            -- objects of different sizes between them shift the addresses
+            objects[#objects + 1] = string.rep("x", i)
+            local avx = Avx:new(i)
+            local line = CacheLine:new(i)
+            objects[#objects + 1] = avx
+            objects[#objects + 1] = line
+            r = r and aligned(avx, line) and avx:sum() == 8 * i and line:sum() == 8 * i
+        end
+        return r
+    )--"));
+}
+
+TEST_F(AlignmentTest, Destruction) {
+    run(R"--(
+        local line = CacheLine:new(1)
+        line:delete()
+        for i = 1, 10 do
+            local l = CacheLine:new(i)
+        end
+    )--");
+    lua_gc(L, LUA_GCCOLLECT);
+}
+
+TEST_F(AlignmentTest, OverAlignedCallables) {
+    for (int i = 1; i <= 8; ++i) {
+        // strings of different sizes between the functions shift the addresses
+        lua_pushlstring(L, "xxxxxxxx", i);
+        lua_setglobal(L, ("padding" + std::to_string(i)).c_str());
+        luabind::function(L, "avxSum" + std::to_string(i), [avx = Avx(static_cast<float>(i))]() {
+            return isAligned(&avx) ? avx.sum() : -1.0f;
+        });
+    }
+
+    int r = run(R"--(
+        for i = 1, 8 do
+            assert(_G['avxSum' .. i]() == 8 * i)
+        end
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
@@ -87,3 +87,188 @@ TEST_F(BaseClassBindingTest, BaseClassBindingTest) {
 
     EXPECT_EQ(r, LUA_OK);
 }
+
+struct Level0 : luabind::Object {
+    std::string_view name() const {
+        return "Level0";
+    }
+
+    std::string_view level0() const {
+        return "level0";
+    }
+
+    int value = 0;
+};
+
+struct Level1 : Level0 {
+    std::string_view name() const {
+        return "Level1";
+    }
+};
+
+struct Level2 : Level1 {};
+
+struct Level3 : Level2 {
+    std::string_view level3() const {
+        return "level3";
+    }
+};
+
+class DeepHierarchyTest : public LuaTest {
+protected:
+    void SetUp() override {
+        const int top = lua_gettop(L);
+        luabind::class_<Level0>(L, "Level0").function("name", &Level0::name).function("level0", &Level0::level0);
+        luabind::class_<Level1, Level0>(L, "Level1").function("name", &Level1::name);
+        luabind::class_<Level2, Level1>(L, "Level2");
+        luabind::class_<Level3, Level2>(L, "Level3").function("level3", &Level3::level3);
+        EXPECT_EQ(lua_gettop(L), top);
+    }
+};
+
+TEST_F(DeepHierarchyTest, InheritedMembers) {
+    int r = run(R"--(
+        o = Level3:new()
+        assert(o:name() == "Level1")
+        assert(o:level0() == "level0")
+        assert(o:level3() == "level3")
+        assert(Level0:new():name() == "Level0")
+        assert(Level2:new():name() == "Level1")
+        assert(Level2:new().level3 == nil)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
+
+TEST_F(DeepHierarchyTest, BaseMembersAddedAfterChild) {
+    luabind::class_<Level0>(L, "Level0").property("value", &Level0::value);
+    luabind::class_<Level2>(L, "Level2").function("name", [](const Level2*) -> std::string_view { return "Level2"; });
+    int r = run(R"--(
+        o = Level3:new()
+        assert(o.value == 0)
+        o.value = 3
+        assert(o.value == 3)
+        assert(o:name() == "Level2")
+        assert(Level1:new():name() == "Level1")
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
+
+struct Padding {
+    virtual ~Padding() = default;
+    double padding[3] = {};
+};
+
+struct OffsetBase : luabind::Object {
+    int value = 1;
+};
+
+// OffsetBase and luabind::Object are not at the beginning of the object
+struct OffsetDerived : Padding, OffsetBase {
+    int own = 2;
+};
+
+struct VirtualBase : virtual luabind::Object {
+    int value = 3;
+};
+
+struct VirtualDerived : virtual VirtualBase {
+    int own = 4;
+};
+
+TEST_F(LuaTest, BaseClassOffsets) {
+    luabind::class_<OffsetBase>(L, "OffsetBase").property("value", &OffsetBase::value);
+    luabind::class_<OffsetDerived, OffsetBase>(L, "OffsetDerived").property("own", &OffsetDerived::own);
+    luabind::class_<VirtualBase>(L, "VirtualBase").property("value", &VirtualBase::value);
+    luabind::class_<VirtualDerived, VirtualBase>(L, "VirtualDerived").property("own", &VirtualDerived::own);
+    luabind::function(L, "sum", [](const OffsetBase* base, const OffsetDerived& derived) {
+        return base->value + derived.own;
+    });
+    luabind::function(L, "virtualSum", [](const VirtualBase* base, const VirtualDerived& derived) {
+        return base->value + derived.own;
+    });
+
+    int r = run(R"--(
+        local d = OffsetDerived:new()
+        assert(d.value == 1)
+        assert(d.own == 2)
+        d.value = 5
+        assert(sum(d, d) == 7)
+
+        local v = VirtualDerived:new()
+        assert(v.value == 3)
+        assert(v.own == 4)
+        assert(virtualSum(v, v) == 7)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+
+    r = run("sum(OffsetBase:new(), OffsetBase:new())");
+    EXPECT_NE(r, LUA_OK);
+}
+
+struct Mixin : virtual luabind::Object {};
+
+struct Combined : VirtualDerived, Mixin {};
+
+TEST_F(DeepHierarchyTest, IsInstance) {
+    luabind::class_<VirtualBase>(L, "VirtualBase");
+    luabind::class_<VirtualDerived, VirtualBase>(L, "VirtualDerived");
+    luabind::class_<Mixin>(L, "Mixin");
+    luabind::class_<Combined, VirtualDerived, Mixin>(L, "Combined");
+
+    int r = run(R"--(
+        local l2 = Level2:new()
+        assert(Level0:isInstance(l2))
+        assert(Level1:isInstance(l2))
+        assert(Level2:isInstance(l2))
+        assert(not Level3:isInstance(l2))
+        assert(Level0:isInstance(Level3:new()))
+        assert(not Level0:isInstance(VirtualBase:new()))
+
+        local c = Combined:new()
+        assert(Combined:isInstance(c))
+        assert(VirtualDerived:isInstance(c))
+        assert(VirtualBase:isInstance(c))
+        assert(Mixin:isInstance(c))
+        assert(not Mixin:isInstance(VirtualDerived:new()))
+
+        assert(not Level0:isInstance(nil))
+        assert(not Level0:isInstance({}))
+        assert(not Level0:isInstance(io.stdout))
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
+
+struct Level4 : Level3 {};
+
+TEST_F(DeepHierarchyTest, IsInstanceAfterRegistration) {
+    EXPECT_FALSE(runWithResult<bool>("return Level3:isInstance(Level2:new())"));
+    // the types are numbered again after the new registration
+    luabind::class_<Level4, Level3>(L, "Level4");
+    EXPECT_TRUE(runWithResult<bool>("return Level1:isInstance(Level4:new()) and not Level4:isInstance(Level3:new())"));
+
+    auto bindReserved = [this]() {
+        luabind::class_<Level4>(L, "Level4").class_function("isInstance", []() { return true; });
+    };
+    EXPECT_THROW(bindReserved(), luabind::error);
+    EXPECT_FALSE(runWithResult<bool>("return Level4:isInstance(Level3:new())"));
+}
+
+struct Animal : luabind::Object {};
+
+struct Dog : Animal {
+    std::string_view bark() const {
+        return "woof";
+    }
+};
+
+TEST_F(LuaTest, UndeclaredBaseDynamicType) {
+    static Dog dog;
+    luabind::class_<Animal>(L, "Animal");
+    luabind::class_<Dog>(L, "Dog").function("bark", &Dog::bark);
+    luabind::function(L, "getAnimal", []() -> Animal* { return &dog; });
+
+    int r = run(R"--(
+        assert(getAnimal():bark() == "woof")
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 class Account : public luabind::Object {
 public:
@@ -460,3 +461,157 @@ TEST_F(ArrayTest, ArrayAccess) {
     )--");
     EXPECT_EQ(r, LUA_OK);
 }
+
+struct Samples : luabind::Object {
+    std::vector<double> values;
+
+    Samples(int size)
+        : values(size) {}
+
+    double get(size_t idx) const {
+        check(idx);
+        return values[idx - 1];
+    }
+
+    void set(size_t idx, double value) {
+        check(idx);
+        values[idx - 1] = value;
+    }
+
+    void check(size_t idx) const {
+        if (idx < 1 || idx > values.size()) {
+            luabind::reportError("Index %zu is out of range.", idx);
+        }
+    }
+};
+
+// accessors report errors by exceptions even with LUABIND_NOTHROW_CALLS
+template <typename Member>
+inline constexpr bool luabind::throwing_callable_v<Member Samples::*> = true;
+
+TEST_F(LuaTest, ArrayRangeAccess) {
+    luabind::class_<Samples>(L, "Samples")
+        .constructor<int>("new")
+        .array_range_access(&Samples::get, &Samples::set)
+        .function("size", [](const Samples& s) { return static_cast<int>(s.values.size()); });
+
+    int r = run(R"--(
+        s = Samples:new(6)
+        s:fillRange(1, 7, 0.5)
+        s:setRange(2, {1, 2, 3})
+        s[6] = 6
+        local t = s:getRange(1, 7)
+        assert(#t == 6)
+        assert(t[1] == 0.5 and t[2] == 1 and t[3] == 2 and t[4] == 3 and t[5] == 0.5 and t[6] == 6)
+        assert(#s:getRange(3, 3) == 0)
+        assert(s[4] == 3)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+
+    runExpectingError("s:setRange(1, 2)", testing::HasSubstr("Expecting 'table'"));
+    runExpectingError("s:setRange(5, {1, 2, 3})", testing::HasSubstr("Index 7 is out of range."));
+    runExpectingError("s:setRange(1, {7, 'x'})",
+                      testing::HasSubstr("Argument at 3, element 2 has invalid type. Expecting 'number'"));
+    runExpectingError("s:getRange(0, 2)", testing::HasSubstr("Index 0 is out of range."));
+    runExpectingError("s:getRange(1)",
+                      testing::HasSubstr("Invalid number of arguments, should be 3, but 2 were given."));
+    runExpectingError("s:fillRange(1, 2)", testing::HasSubstr("Invalid number of arguments, should be 4"));
+    runExpectingError("s:getRange(math.mininteger, math.maxinteger)", testing::HasSubstr("is too large"));
+    // the elements before the invalid one are assigned
+    EXPECT_EQ(runWithResult<double>("return s[1]"), 7);
+}
+
+TEST_F(LuaTest, ArrayRangeAccessNames) {
+    // nothing is bound if the names are taken
+    auto bindSame = [this]() {
+        luabind::class_<Samples>(L, "Samples").array_range_access(&Samples::get, &Samples::set, "range", "range");
+    };
+    EXPECT_THROW(bindSame(), luabind::error);
+    auto bindTaken = [this]() {
+        luabind::class_<Samples>(L, "Samples")
+            .function("setRange", [](const Samples&) { return true; })
+            .array_range_access(&Samples::get, &Samples::set);
+    };
+    EXPECT_THROW(bindTaken(), luabind::error);
+
+    luabind::class_<Samples>(L, "Samples")
+        .constructor<int>("new")
+        .array_range_access(&Samples::get, &Samples::set, "slice", "assign", "fill");
+    int r = run(R"--(
+        local s = Samples:new(3)
+        s:fill(1, 4, 2)
+        s:assign(1, {5})
+        local t = s:slice(1, 4)
+        assert(t[1] == 5 and t[2] == 2 and t[3] == 2)
+        assert(s.getRange == nil and s.fillRange == nil and s.range == nil)
+        assert(s:setRange())
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
+
+struct LongNames : luabind::Object {
+    int value = 0;
+
+    int incrementWithAVeryLongFunctionNameWhichLuaDoesNotIntern() {
+        return ++value;
+    }
+};
+
+TEST_F(LuaTest, LongMemberNames) {
+    luabind::class_<LongNames>(L, "LongNames")
+        .function("increment", &LongNames::incrementWithAVeryLongFunctionNameWhichLuaDoesNotIntern)
+        .function("incrementWithAVeryLongFunctionNameWhichLuaDoesNotIntern",
+                  &LongNames::incrementWithAVeryLongFunctionNameWhichLuaDoesNotIntern)
+        .property("valueAccessedWithAVeryLongPropertyNameWhichLuaDoesNotIntern", &LongNames::value);
+
+    int r = run(R"--(
+        o = LongNames:new()
+        assert(o:increment() == 1)
+        local name = 'incrementWithAVeryLongFunctionName' .. 'WhichLuaDoesNotIntern'
+        assert(o[name](o) == 2)
+        assert(o:incrementWithAVeryLongFunctionNameWhichLuaDoesNotIntern() == 3)
+        assert(o.valueAccessedWithAVeryLongPropertyNameWhichLuaDoesNotIntern == 3)
+        o.valueAccessedWithAVeryLongPropertyNameWhichLuaDoesNotIntern = 7
+        assert(o:increment() == 8)
+        assert(o.someOtherVeryLongFieldNameWhichIsNotBoundToAnyMember == nil)
+        o.someOtherVeryLongFieldNameWhichIsNotBoundToAnyMember = 5
+        assert(o.someOtherVeryLongFieldNameWhichIsNotBoundToAnyMember == 5)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
+
+struct ManyMembers : luabind::Object {
+    int value = 0;
+};
+
+TEST_F(LuaTest, ManyMembers) {
+    luabind::class_<ManyMembers> cls(L, "ManyMembers");
+    for (int i = 0; i < 300; ++i) {
+        auto name = std::to_string(i).insert(0, "get");
+        cls.function(name, [i](ManyMembers* self) { return self->value + i; });
+    }
+
+    int r = run(R"--(
+        o = ManyMembers:new()
+        for i = 0, 299 do
+            assert(o['get' .. i](o) == i)
+        end
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
+
+TEST(LuaStateTest, ReopenState) {
+    for (int i = 0; i < 2; ++i) {
+        lua_State* L = luaL_newstate();
+        luabind::init(L);
+        luaL_openlibs(L);
+        luabind::class_<Account>(L, "Account").constructor<int>("new").function("getBalance", &Account::getBalance);
+        int r = luaL_dostring(L, R"--(
+            local a = Account:new(5)
+            local co = coroutine.wrap(function() return Account:new(7):getBalance() end)
+            assert(a:getBalance() + co() == 12)
+        )--");
+        EXPECT_EQ(r, LUA_OK) << lua_tostring(L, -1);
+        lua_close(L);
+    }
+}
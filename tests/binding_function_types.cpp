@@ -131,3 +131,143 @@ TEST_F(BindFunctions, ClassFunctionBinding) {
     )--");
     EXPECT_EQ(o._x, 13);
 }
+
+struct MethodTableBase : luabind::Object {
+    int base() const {
+        return 1;
+    }
+};
+
+struct MethodTableLate : MethodTableBase {};
+
+struct MethodTableDerived : MethodTableBase {
+    int derived() const {
+        return 2;
+    }
+
+    int _x = 0;
+};
+
+class MethodTableBinding : public LuaTest {
+protected:
+    void SetUp() override {
+        const int top = lua_gettop(L);
+        luabind::class_<MethodTableBase>(L, "MethodTableBase", luabind::binding_mode::method_table)
+            .function("base", &MethodTableBase::base);
+        luabind::class_<MethodTableDerived, MethodTableBase>(
+            L, "MethodTableDerived", luabind::binding_mode::method_table)
+            .function("derived", &MethodTableDerived::derived)
+            .function("set", [](MethodTableDerived& self, int x) { self._x = x; });
+        EXPECT_EQ(lua_gettop(L), top);
+    }
+};
+
+TEST_F(MethodTableBinding, Functions) {
+    auto o = runWithResult<MethodTableDerived>(R"--(
+        local t = MethodTableDerived:new()
+        assert(t:base() == 1)
+        assert(t:derived() == 2)
+        assert(t.unknown == nil)
+        assert(type(getmetatable(t).__index) == "table")
+        t:set(3)
+        return t
+    )--");
+    EXPECT_EQ(o._x, 3);
+}
+
+TEST_F(MethodTableBinding, BaseFunctionsAddedAfterChild) {
+    luabind::class_<MethodTableBase>(L, "MethodTableBase").function("late", [](const MethodTableBase*) { return 4; });
+    int r = run(R"--(
+        local t = MethodTableDerived:new()
+        assert(t:late() == 4)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
+
+TEST_F(MethodTableBinding, CustomFields) {
+    runExpectingError(R"--(
+        local t = MethodTableDerived:new()
+        t.custom = 1
+    )--",
+                      testing::HasSubstr("Type 'MethodTableDerived' is bound with a method table, can't assign "
+                                         "custom field 'custom'."));
+}
+
+TEST_F(MethodTableBinding, PropertiesSwitchToIndexFunction) {
+    // the derived type inherits the property, so both switch to the __index function
+    luabind::class_<MethodTableBase>(L, "MethodTableBase").property("x", [](const MethodTableBase*) { return 5; });
+    int r = run(R"--(
+        local t = MethodTableDerived:new()
+        assert(type(getmetatable(t).__index) == "function")
+        assert(type(getmetatable(MethodTableBase:new()).__index) == "function")
+        assert(t.x == 5 and t:base() == 1 and t:derived() == 2)
+        t.custom = 1
+        assert(t.custom == 1)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+
+    // derived types bound later switch on registration
+    luabind::class_<MethodTableLate, MethodTableBase>(L, "MethodTableLate", luabind::binding_mode::method_table);
+    EXPECT_TRUE(runWithResult<bool>(R"--(
+        local t = MethodTableLate:new()
+        return type(getmetatable(t).__index) == "function" and t.x == 5 and t:base() == 1
+    )--"));
+}
+
+struct MethodTableArray : luabind::Object {
+    int get(int i) const {
+        return i * 2;
+    }
+};
+
+TEST_F(MethodTableBinding, ArrayAccessSwitchesToIndexFunction) {
+    luabind::class_<MethodTableArray>(L, "MethodTableArray", luabind::binding_mode::method_table)
+        .array_range_access(&MethodTableArray::get);
+    int r = run(R"--(
+        local a = MethodTableArray:new()
+        assert(a[2] == 4)
+        local t = a:getRange(1, 3)
+        assert(t[1] == 2 and t[2] == 4)
+        -- types without such members keep the method table
+        assert(type(getmetatable(MethodTableDerived:new()).__index) == "table")
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
+
+int staticSum(int a, int b) {
+    return a + b;
+}
+
+TEST_F(LuaTest, StaticFunctions) {
+    luabind::class_<SomeClass>(L, "SomeClass")
+        .function<&SomeClass::memberFunction>("memberFunction")
+        .function<&SomeClass::luaFunction>("luaFunction")
+        .function<[](SomeClass& self, int x) { self._x = x * 2; }>("lambdaFunction")
+        .class_function<&SomeClass::create>("create");
+    luabind::function<&staticSum>(L, "sum");
+
+    runExpectingError("sum(1)", testing::HasSubstr("Invalid number of arguments"));
+    runExpectingError("SomeClass:new():memberFunction('x')",
+                      testing::HasSubstr("Expecting 'integer', but got 'string'"));
+
+    EXPECT_EQ(runWithResult<int>("return sum(2, 3)"), 5);
+    EXPECT_EQ(runWithResult<SomeClass>("return SomeClass:create(4)")._x, 4);
+    EXPECT_EQ(runWithResult<SomeClass>(R"--(
+        local t = SomeClass:new()
+        t:memberFunction(1)
+        return t
+    )--")._x,
+              1);
+    EXPECT_EQ(runWithResult<SomeClass>(R"--(
+        local t = SomeClass:new()
+        t:luaFunction(2)
+        return t
+    )--")._x,
+              2);
+    EXPECT_EQ(runWithResult<SomeClass>(R"--(
+        local t = SomeClass:new()
+        t:lambdaFunction(3)
+        return t
+    )--")._x,
+              6);
+}
@@ -0,0 +1,111 @@
+#include "lua_test.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct Entity : luabind::Object {
+    Entity(int id)
+        : id(id) {}
+
+    int id;
+};
+
+struct Point final {
+    int x = 0;
+    int y = 0;
+};
+
+struct World : luabind::Object {
+    std::vector<Entity> entities;
+    std::map<std::string, Entity*> named;
+    std::vector<Point> points {{1, 2}, {3, 4}};
+    std::vector<int> ids {7, 8, 9};
+};
+
+class ContainerProxyTest : public LuaTest {
+protected:
+    void SetUp() override {
+        const int top = lua_gettop(L);
+        luabind::class_<Entity>(L, "Entity").identity_cache().property("id", &Entity::id);
+        luabind::class_<Point>(L, "Point").property("x", &Point::x).property("y", &Point::y);
+        luabind::class_<World>(L, "World")
+            .function("entities", [](World& w) { return luabind::container_proxy(w.entities); })
+            .function("named", [](World& w) { return luabind::container_proxy(w.named); })
+            .function("points", [](World& w) { return luabind::container_proxy(w.points); })
+            .function("ids", [](World& w) { return luabind::container_proxy(w.ids); })
+            .function("addIds", [](World& w, int count) { w.ids.resize(w.ids.size() + count, 1); });
+        EXPECT_EQ(lua_gettop(L), top);
+
+        for (int i = 1; i <= 5; ++i) {
+            world.entities.emplace_back(i * 10);
+        }
+        world.named = {{"first", &world.entities[0]}, {"last", &world.entities[4]}};
+        luabind::value_mirror<World*>::to_lua(L, &world);
+        lua_setglobal(L, "world");
+    }
+
+    World world;
+};
+
+TEST_F(ContainerProxyTest, Sequences) {
+    int r = run(R"--(
+        local entities = world:entities()
+        assert(#entities == 5)
+        assert(entities[1].id == 10 and entities[5].id == 50)
+        assert(entities[0] == nil and entities[6] == nil and entities.x == nil)
+        assert(entities[2] == entities[2])
+        entities[3].id = 33
+
+        local points = world:points()
+        points[2].x = 30
+
+        local sum = 0
+        for i, id in pairs(world:ids()) do
+            sum = sum + i * id
+        end
+        assert(sum == 7 + 16 + 27)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+    // elements are referenced, not copied
+    EXPECT_EQ(world.entities[2].id, 33);
+    EXPECT_EQ(world.points[1].x, 30);
+}
+
+TEST_F(ContainerProxyTest, Maps) {
+    int r = run(R"--(
+        local named = world:named()
+        assert(#named == 2)
+        assert(named.first == world:entities()[1])
+        assert(named.last.id == 50 and named.none == nil)
+        -- keys of other types miss, like in lua tables
+        assert(named[1] == nil and named[true] == nil and named[named] == nil)
+
+        local keys = {}
+        for name, entity in pairs(named) do
+            keys[#keys + 1] = name .. entity.id
+        end
+        assert(#keys == 2 and keys[1] == "first10" and keys[2] == "last50")
+        assert(getmetatable(named) == "container")
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
+
+TEST_F(ContainerProxyTest, ModifiedWhileIterating) {
+    // the vector is reallocated, iteration continues by index over the new elements
+    int r = run(R"--(
+        local count = 0
+        for i, id in pairs(world:ids()) do
+            count = count + 1
+            if i == 2 then
+                world:addIds(100)
+            end
+        end
+        assert(count == 103)
+
+        local iterate = pairs(world:ids())
+        assert(iterate(nil, -1) == nil and iterate(nil, math.maxinteger) == nil)
+        assert(select(2, iterate(nil, 102)) == 1)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
@@ -0,0 +1,115 @@
+#include "lua_test.hpp"
+
+#include <array>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Account : luabind::Object {
+    Account(int balance)
+        : balance(balance) {}
+
+    int balance;
+};
+
+struct Bank : luabind::Object {
+    std::map<std::string, Account*> accounts;
+
+    std::vector<std::string> names() const {
+        std::vector<std::string> r;
+        for (const auto& [name, _] : accounts) {
+            r.push_back(name);
+        }
+        return r;
+    }
+
+    const std::map<std::string, Account*>& getAccounts() const {
+        return accounts;
+    }
+
+    void setAccounts(const std::map<std::string, Account*>& v) {
+        accounts = v;
+    }
+};
+
+class ContainersTest : public LuaTest {
+protected:
+    void SetUp() override {
+        const int top = lua_gettop(L);
+        luabind::class_<Account>(L, "Account").constructor<int>("new").property("balance", &Account::balance);
+        luabind::class_<Bank>(L, "Bank")
+            .constructor<>("new")
+            .function("names", &Bank::names)
+            .function("getAccounts", &Bank::getAccounts)
+            .function("setAccounts", &Bank::setAccounts);
+        luabind::function(L, "reverse", [](std::vector<int> v) { return std::vector<int>(v.rbegin(), v.rend()); });
+        luabind::function(L, "cross", [](const std::array<double, 3>& a, const std::array<double, 3>& b) {
+            return std::array<double, 3> {
+                a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+        });
+        luabind::function(L, "lengths", [](const std::vector<std::vector<int>>& v) {
+            std::unordered_map<int, size_t> r;
+            for (size_t i = 0; i < v.size(); ++i) {
+                r[static_cast<int>(i + 1)] = v[i].size();
+            }
+            return r;
+        });
+        EXPECT_EQ(lua_gettop(L), top);
+    }
+};
+
+TEST_F(ContainersTest, Sequences) {
+    int r = run(R"--(
+        local v = reverse({1, 2, 3})
+        assert(#v == 3 and v[1] == 3 and v[3] == 1)
+        assert(#reverse({}) == 0)
+
+        local c = cross({1, 0, 0}, {0, 1, 0})
+        assert(c[1] == 0 and c[2] == 0 and c[3] == 1)
+
+        local l = lengths({{1, 2}, {}, {3}})
+        assert(l[1] == 2 and l[2] == 0 and l[3] == 1)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+
+    runExpectingError("reverse(1)", testing::HasSubstr("Expecting 'table', but got 'number'"));
+    runExpectingError("reverse({1, 'x'})",
+                      testing::HasSubstr("Argument at 1, element 2 has invalid type. Expecting 'integer'"));
+    runExpectingError("cross({1, 0}, {0, 1, 0})", testing::HasSubstr("should have 3 elements, but has 2"));
+    runExpectingError("cross({1, 0, 0}, {0, 1, 'x'})",
+                      testing::HasSubstr("Argument at 2, element 3 has invalid type. Expecting 'number'"));
+    runExpectingError("lengths({{1}, {2, 'x'}})",
+                      testing::HasSubstr("Argument at 1, element 2, element 2 has invalid type"));
+    runExpectingError("lengths({{1}, 2})",
+                      testing::HasSubstr("Argument at 1, element 2 has invalid type. Expecting 'table'"));
+}
+
+TEST_F(ContainersTest, Maps) {
+    int r = run(R"--(
+        bank = Bank:new()
+        a = Account:new(10)
+        b = Account:new(20)
+        bank:setAccounts({alice = a, bob = b})
+        local names = bank:names()
+        assert(#names == 2 and names[1] == "alice" and names[2] == "bob")
+        local accounts = bank:getAccounts()
+        assert(accounts.alice.balance == 10 and accounts.bob.balance == 20)
+        accounts.bob.balance = 30
+        assert(b.balance == 30)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+
+    runExpectingError("bank:setAccounts({alice = 1})",
+                      testing::HasSubstr("Argument at 2, value of key 'alice' has invalid type. Expecting user_data"));
+    runExpectingError("bank:setAccounts({[1] = a})",
+                      testing::HasSubstr("Argument at 2, key 1 has invalid type. Expecting 'string'"));
+}
+
+TEST_F(ContainersTest, CppSide) {
+    const std::map<std::string, std::vector<int>> m {{"a", {1, 2}}, {"b", {}}};
+    luabind::value_mirror<std::map<std::string, std::vector<int>>>::to_lua(L, m);
+    auto back = luabind::value_mirror<std::map<std::string, std::vector<int>>>::from_lua(L, -1);
+    lua_pop(L, 1);
+    EXPECT_EQ(back, m);
+}
@@ -96,6 +96,9 @@ TEST_F(CustomFunctionTest, ObjCustomTable) {
     auto value = lua_tointeger(L, -1);
     EXPECT_EQ(value, 40);
     lua_pop(L, 2);
+    EXPECT_TRUE(luabind::user_data::try_get_custom_table(L, -1));
+    EXPECT_EQ(lua_getfield(L, -1, "customProperty"), LUA_TNUMBER);
+    lua_pop(L, 2);
 
     lua_newtable(L);
     lua_pushinteger(L, 34);
@@ -107,3 +110,104 @@ TEST_F(CustomFunctionTest, ObjCustomTable) {
     EXPECT_EQ(value, 34);
     lua_pop(L, 1);
 }
+
+TEST_F(CustomFunctionTest, ObjCustomTableIsLazy) {
+    run(R"--(
+        obj = IntWrapper:new(13)
+        assert(obj.customProperty == nil)
+        return obj
+    )--");
+
+    EXPECT_EQ(luabind::user_data::find_custom_table(L, -1), LUA_TNIL);
+    lua_pop(L, 1);
+
+    run(R"--(
+        obj.customProperty = 40
+        assert(obj.customProperty == 40)
+        return obj
+    )--");
+
+    EXPECT_EQ(luabind::user_data::find_custom_table(L, -1), LUA_TTABLE);
+    lua_getfield(L, -1, "customProperty");
+    EXPECT_EQ(lua_tointeger(L, -1), 40);
+    lua_pop(L, 3);
+}
+
+struct Entity : luabind::Object {
+    int id = 0;
+};
+
+struct Boss : Entity {};
+
+struct Particle : luabind::Object {};
+
+struct WithFields : virtual luabind::Object {};
+
+struct WithoutFields : virtual luabind::Object {};
+
+struct Mixed : WithoutFields, WithFields {};
+
+TEST_F(LuaTest, DeclaredFields) {
+    luabind::class_<Entity> entity(L, "Entity");
+    entity.property("id", &Entity::id).field("health").field("target");
+    luabind::class_<Boss, Entity>(L, "Boss").field("phase");
+    // slots of the derived types are already taken
+    EXPECT_THROW(entity.field("late"), luabind::error);
+    luabind::class_<Particle>(L, "Particle").sealed();
+    luabind::class_<IntWrapper>(L, "SealedWrapper").sealed().field("value");
+
+    runExpectingError("Particle:new().x = 1", testing::HasSubstr("Type 'Particle' is sealed"));
+    runExpectingError("local w = SealedWrapper:new(); w.value = 1; w.other = 2",
+                      testing::HasSubstr("Type 'SealedWrapper' is sealed, can't assign custom field 'other'"));
+
+    run(R"--(
+        entity = Entity:new()
+        assert(entity.health == nil)
+        entity.health = 40
+        entity.target = entity
+        boss = Boss:new()
+        boss.health = 100
+        boss.phase = "rage"
+        boss.id = 3
+        particle = Particle:new()
+        assert(particle.x == nil)
+    )--");
+
+    lua_getglobal(L, "entity");
+    // declared fields don't create the custom table
+    EXPECT_EQ(luabind::user_data::find_custom_table(L, -1), LUA_TNIL);
+    EXPECT_EQ(lua_getiuservalue(L, -2, 2), LUA_TNUMBER);
+    EXPECT_EQ(lua_tointeger(L, -1), 40);
+    EXPECT_EQ(lua_getiuservalue(L, -3, 4), LUA_TNONE);
+    lua_pop(L, 4);
+
+    lua_getglobal(L, "boss");
+    EXPECT_EQ(luabind::user_data::find_custom_table(L, -1), LUA_TNIL);
+    EXPECT_EQ(lua_getiuservalue(L, -2, 4), LUA_TSTRING);
+    lua_pop(L, 3);
+
+    // sealed objects without fields have no user values at all
+    lua_getglobal(L, "particle");
+    EXPECT_EQ(luabind::user_data::find_custom_table(L, -1), LUA_TNONE);
+    lua_pop(L, 1);
+    EXPECT_THROW(luabind::user_data::get_custom_table(L, -1), luabind::error);
+    EXPECT_FALSE(luabind::user_data::try_get_custom_table(L, -1));
+    lua_pop(L, 1);
+    run("wrapper = SealedWrapper:new()");
+    lua_getglobal(L, "wrapper");
+    EXPECT_THROW(luabind::user_data::get_custom_table(L, -1), luabind::error);
+    lua_pop(L, 1);
+
+    EXPECT_EQ(runWithResult<int>("return boss.health + entity.health + boss.id"), 143);
+    EXPECT_EQ(runWithResult<std::string>("return boss.phase"), "rage");
+    EXPECT_TRUE(runWithResult<bool>("return entity.target == entity"));
+}
+
+TEST_F(LuaTest, FieldsOfSecondBase) {
+    luabind::class_<WithFields>(L, "WithFields").field("value");
+    luabind::class_<WithoutFields>(L, "WithoutFields");
+    auto bindMixed = [this]() { luabind::class_<Mixed, WithoutFields, WithFields>(L, "Mixed"); };
+    EXPECT_THROW(bindMixed(), luabind::error);
+    // the type is not registered partially
+    EXPECT_EQ(luabind::type_storage::find_type_info<Mixed>(L), nullptr);
+}
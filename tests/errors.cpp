@@ -127,6 +127,21 @@ TEST_F(StrLuaTest, MirrorErrors) {
     )--",
         testing::StartsWith("Argument at 2 has invalid type. Expecting 'String' but got 'Numeric'."));
 
+    runExpectingError(
+        R"--(
+        a = String:new('aaa')
+        a:copy(io.stdout)
+    )--",
+        testing::StartsWith(
+            "Argument at 2 has invalid type. Expecting user_data of type 'String', but got lua type 'userdata'"));
+
+    runExpectingError(
+        R"--(
+        a = String:new('aaa')
+        getmetatable(a).__index(io.stdout, 'get')
+    )--",
+        testing::HasSubstr("Expecting 'String', but got 'userdata'."));
+
     runExpectingError(
         R"--(
         u = Numeric:new()
@@ -241,3 +256,59 @@ TEST_F(StrLuaTest, WrapperErrors) {
     )--",
         testing::StartsWith("Invalid number of arguments, should be 1, but 2 were given."));
 }
+
+TEST_F(StrLuaTest, PropertyErrors) {
+    runExpectingError(
+        R"--(
+        s = String:new('abc')
+        s.str = 5
+    )--",
+        testing::StartsWith("Argument at 3 has invalid type. Expecting 'string', but got 'number'."));
+}
+
+void nothrowNumbers(int, double, bool) noexcept {}
+
+void nothrowString(const std::string&) noexcept {}
+
+static_assert(luabind::invoker<decltype(&nothrowNumbers), void(int, double, bool), 1>::nothrow);
+static_assert(!luabind::invoker<decltype(&nothrowString), void(const std::string&), 1>::nothrow ||
+              luabind::lua_error_unwinds);
+static_assert(!luabind::invoker<void (*)(int), void(int), 1>::nothrow || luabind::nothrow_calls);
+
+// value type, which is not bound, so it can't be pushed
+struct Unbound final {
+    int x = 0;
+};
+
+Unbound makeUnbound() noexcept {
+    return {};
+}
+
+static_assert(!luabind::invoker<decltype(&makeUnbound), Unbound(), 1>::nothrow);
+
+TEST_F(StrLuaTest, NothrowCallErrors) {
+    luabind::function(L, "nothrowNumbers", &nothrowNumbers);
+    luabind::function(L, "nothrowString", &nothrowString);
+    luabind::function(L, "nothrowLength", [](const String& s) noexcept { return s.str.size(); });
+    luabind::function(L, "makeUnbound", &makeUnbound);
+
+    runExpectingError("nothrowNumbers(1, 2.5)",
+                      testing::StartsWith("Invalid number of arguments, should be 3, but 2 were given."));
+    runExpectingError("nothrowNumbers(1, 'abc', true)",
+                      testing::StartsWith("Argument at 2 has invalid type. Expecting 'number', but got 'string'."));
+    runExpectingError("nothrowString(5)",
+                      testing::StartsWith("Argument at 1 has invalid type. Expecting 'string', but got 'number'."));
+    runExpectingError("nothrowLength(Numeric:new())",
+                      testing::StartsWith("Argument at 1 has invalid type. Expecting 'String' but got 'Numeric'."));
+    runExpectingError("pcall(makeUnbound) makeUnbound()",
+                      testing::HasSubstr("should be bound before passing it to lua"));
+
+    int r = run(R"--(
+        for i = 1, 100 do
+            assert(not pcall(nothrowNumbers, i, i, i))
+        end
+        nothrowNumbers(1, 2.5, true)
+        assert(nothrowLength(String:new('abc')) == 3)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
@@ -44,3 +44,19 @@ TEST_F(ExplicitDeleteTest, ExplicitDelete) {
 
     EXPECT_EQ(Deletable::deletedCount, 2);
 }
+
+TEST_F(ExplicitDeleteTest, UserDataSize) {
+    // user data header is made of the object pointer and the type info pointer with packed lifetime
+    Deletable d;
+    luabind::value_mirror<Deletable*>::to_lua(L, &d);
+    EXPECT_EQ(lua_rawlen(L, -1), 2 * sizeof(void*));
+    lua_pop(L, 1);
+
+    luabind::value_mirror<Deletable>::to_lua(L, Deletable {});
+    EXPECT_EQ(lua_rawlen(L, -1), 2 * sizeof(void*) + sizeof(Deletable));
+    lua_pop(L, 1);
+
+    luabind::value_mirror<std::shared_ptr<Deletable>>::to_lua(L, std::make_shared<Deletable>());
+    EXPECT_EQ(lua_rawlen(L, -1), 2 * sizeof(void*) + sizeof(std::shared_ptr<Deletable>));
+    lua_pop(L, 1);
+}
@@ -0,0 +1,122 @@
+#include "lua_test.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+struct TreeNode : luabind::Object {
+    TreeNode* parent = nullptr;
+    std::shared_ptr<TreeNode> sibling;
+
+    TreeNode* getParent() {
+        return parent;
+    }
+
+    std::shared_ptr<TreeNode> getSibling() {
+        return sibling;
+    }
+
+    TreeNode* self() {
+        return this;
+    }
+};
+
+struct Plain : luabind::Object {
+    Plain* self() {
+        return this;
+    }
+};
+
+class IdentityCacheTest : public LuaTest {
+protected:
+    void SetUp() override {
+        const int top = lua_gettop(L);
+        luabind::class_<TreeNode>(L, "TreeNode")
+            .identity_cache()
+            .function("getParent", &TreeNode::getParent)
+            .function("getSibling", &TreeNode::getSibling)
+            .function("self", &TreeNode::self);
+        luabind::class_<Plain>(L, "Plain").function("self", &Plain::self);
+
+        EXPECT_EQ(lua_gettop(L), top);
+    }
+
+    void pushNode(const char* name, TreeNode* node) {
+        luabind::value_mirror<TreeNode*>::to_lua(L, node);
+        lua_setglobal(L, name);
+    }
+};
+
+TEST_F(IdentityCacheTest, SameProxy) {
+    TreeNode parent;
+    TreeNode child;
+    child.parent = &parent;
+    child.sibling = std::make_shared<TreeNode>();
+    pushNode("child", &child);
+
+    EXPECT_TRUE(runWithResult<bool>(R"--(
+        local p = child:getParent()
+        p.visited = true
+        return p == child:getParent() and child:getParent().visited
+            and child:getSibling() == child:getSibling() and child:self() == child
+    )--"));
+
+    // objects of other types are pushed as new user data
+    EXPECT_FALSE(runWithResult<bool>("local p = Plain:new(); return p:self() == p"));
+}
+
+TEST_F(IdentityCacheTest, LuaOwned) {
+    EXPECT_TRUE(runWithResult<bool>(R"--(
+        local node = TreeNode:new()
+        node.name = "node"
+        return node:self() == node and node:self().name == "node"
+    )--"));
+}
+
+TEST_F(IdentityCacheTest, Invalidation) {
+    TreeNode node;
+    pushNode("node", &node);
+    run(R"--(
+        first = node:self()
+        first.tag = 1
+        node:delete()
+    )--");
+    pushNode("node", &node);
+    EXPECT_TRUE(runWithResult<bool>("return node ~= first and node.tag == nil"));
+
+    // the cache doesn't keep user data alive
+    auto shared = std::make_shared<TreeNode>();
+    std::weak_ptr<TreeNode> weak = shared;
+    luabind::value_mirror<std::shared_ptr<TreeNode>>::to_lua(L, std::move(shared));
+    lua_pop(L, 1);
+    lua_gc(L, LUA_GCCOLLECT);
+    EXPECT_TRUE(weak.expired());
+
+    // forgotten objects are pushed as new user data
+    TreeNode other;
+    pushNode("other", &other);
+    luabind::user_data::forget(L, &other);
+    pushNode("again", &other);
+    EXPECT_TRUE(runWithResult<bool>("return other ~= again"));
+}
+
+TEST_F(IdentityCacheTest, AddressReuse) {
+    alignas(TreeNode) std::byte storage[sizeof(TreeNode)];
+    auto* node = new (storage) TreeNode;
+    pushNode("node", node);
+    run("node.tag = 1");
+
+    // the cache can't tell the new object at the same address from the destructed one
+    node->~TreeNode();
+    node = new (storage) TreeNode;
+    pushNode("reused", node);
+    EXPECT_TRUE(runWithResult<bool>("return reused == node and reused.tag == 1"));
+
+    // unless the destructed object is forgotten
+    luabind::user_data::forget(L, node);
+    node->~TreeNode();
+    node = new (storage) TreeNode;
+    pushNode("fresh", node);
+    EXPECT_TRUE(runWithResult<bool>("return fresh ~= node and fresh.tag == nil"));
+    node->~TreeNode();
+}
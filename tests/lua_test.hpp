@@ -10,6 +10,7 @@ class LuaTest : public testing::Test {
 protected:
     LuaTest() {
         L = luaL_newstate();
+        luabind::init(L);
         luaL_openlibs(L);
         lua_pushcfunction(L, errorHandler);
         _errorHandlerIndex = lua_gettop(L);
@@ -0,0 +1,82 @@
+#include "lua_test.hpp"
+
+#include <luabind/numeric_array.hpp>
+
+#include <cstdint>
+
+class NumericArrayTest : public LuaTest {
+protected:
+    void SetUp() override {
+        const int top = lua_gettop(L);
+        luabind::numeric_array<float>::bind(L, "FloatArray");
+        luabind::numeric_array<double>::bind(L, "DoubleArray");
+        luabind::numeric_array<std::int64_t>::bind(L, "IntArray");
+        EXPECT_EQ(lua_gettop(L), top);
+    }
+};
+
+TEST_F(NumericArrayTest, Kernels) {
+    // sizes are not multiples of the vector width, so the scalar tail is covered too
+    int r = run(R"--(
+        for _, Array in ipairs({FloatArray, DoubleArray, IntArray}) do
+            local a = Array:new(11, 2)
+            local b = Array:new({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11})
+            assert(#a == 11 and a:size() == 11 and a[11] == 2)
+            assert(b:sum() == 66)
+            assert(a:dot(b) == 132)
+            assert(b:min() == 1 and b:max() == 11)
+
+            a:add(b)
+            assert(a[1] == 3 and a[11] == 13)
+            a:mul(b)
+            assert(a[1] == 3 and a[11] == 143)
+            a:fma(b, b)
+            assert(a[1] == 4 and a[11] == 264)
+            a:scale(2)
+            assert(a[1] == 8 and a[11] == 528)
+            b:clamp(3, 8)
+            assert(b[1] == 3 and b[5] == 5 and b[11] == 8)
+
+            local c = a + b
+            assert(c[1] == 11 and c[11] == 536 and a[1] == 8)
+            local d = a * b
+            assert(d[1] == 24 and d[11] == 4224)
+            local e = 3 * b
+            assert(e[1] == 9 and (b * 3)[11] == 24)
+
+            local t = Array:new({4, 1, 7}):getRange(1, 4)
+            assert(#t == 3 and t[3] == 7)
+            assert(Array:new(0):sum() == 0)
+        end
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+
+    EXPECT_DOUBLE_EQ(runWithResult<double>("return DoubleArray:new({0.5, 1.5}):sum()"), 2.0);
+}
+
+TEST_F(NumericArrayTest, Errors) {
+    runExpectingError("FloatArray:new(2):add(FloatArray:new(3))", testing::HasSubstr("Array sizes differ, 2 and 3."));
+    runExpectingError("local a = FloatArray:new(2) + FloatArray:new(3)", testing::HasSubstr("sizes differ"));
+    runExpectingError("FloatArray:new(0):min()", testing::HasSubstr("Array is empty."));
+    runExpectingError("local a = FloatArray:new(2); a[3] = 1", testing::HasSubstr("out of array range [1, 2]"));
+    runExpectingError("FloatArray:new(2):add(DoubleArray:new(2))", testing::HasSubstr("Expecting"));
+    runExpectingError("IntArray:new({1, 1.5})",
+                      testing::HasSubstr("Argument at 2, element 2 has invalid type. Expecting 'integer'"));
+    runExpectingError("FloatArray:new(-1)", testing::HasSubstr("should not be negative"));
+    runExpectingError("FloatArray:new(math.maxinteger)", testing::HasSubstr("is too large"));
+
+    luabind::class_<luabind::numeric_array<float>>(L, "FloatArray").function<&luabind::numeric_array<float>::get>("at");
+    runExpectingError("FloatArray:new(2):at(3)", testing::HasSubstr("out of array range [1, 2]"));
+}
+
+TEST_F(NumericArrayTest, Memory) {
+    // elements are in the user data, so the collector accounts their memory
+    int r = run(R"--(
+        collectgarbage()
+        local before = collectgarbage('count')
+        local a = DoubleArray:new(100000, 1)
+        assert(collectgarbage('count') - before >= 100000 * 8 / 1024)
+        assert(a[100000] == 1 and a:sum() == 100000)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+}
@@ -0,0 +1,105 @@
+#include "lua_test.hpp"
+
+#include <vector>
+
+struct Mesh : luabind::RefCounted {
+    static inline int destructed = 0;
+
+    Mesh(int vertices)
+        : vertices(vertices) {}
+
+    ~Mesh() override {
+        ++destructed;
+    }
+
+    int vertices;
+};
+
+struct Scene : luabind::Object {
+    std::vector<luabind::ref_ptr<Mesh>> meshes;
+
+    void add(luabind::ref_ptr<Mesh> mesh) {
+        meshes.push_back(std::move(mesh));
+    }
+
+    luabind::ref_ptr<Mesh> get(int i) const {
+        return meshes[i];
+    }
+
+    int vertices(const luabind::ref_ptr<Mesh>& mesh) const {
+        return mesh->vertices;
+    }
+};
+
+class RefCountedTest : public LuaTest {
+protected:
+    void SetUp() override {
+        Mesh::destructed = 0;
+        const int top = lua_gettop(L);
+        luabind::class_<Mesh>(L, "Mesh")
+            .constructor<int>("new")
+            .construct_intrusive<int>("create")
+            .property_readonly("vertices", &Mesh::vertices);
+        luabind::class_<Scene>(L, "Scene")
+            .constructor<>("new")
+            .function("add", &Scene::add)
+            .function("get", &Scene::get)
+            .function("vertices", &Scene::vertices);
+        EXPECT_EQ(lua_gettop(L), top);
+    }
+};
+
+TEST_F(RefCountedTest, SharedOwnership) {
+    Scene scene;
+    luabind::value_mirror<Scene*>::to_lua(L, &scene);
+    lua_setglobal(L, "scene");
+
+    EXPECT_EQ(runWithResult<int>(R"--(
+        local mesh = Mesh:create(12)
+        scene:add(mesh)
+        return scene:vertices(mesh)
+    )--"),
+              12);
+    ASSERT_EQ(scene.meshes.size(), 1u);
+    lua_gc(L, LUA_GCCOLLECT);
+    EXPECT_EQ(Mesh::destructed, 0);
+    EXPECT_EQ(scene.meshes[0]->ref_count(), 1u);
+
+    // the object is pushed back without copy
+    EXPECT_EQ(runWithResult<int>("local m = scene:get(0); return m.vertices"), 12);
+    scene.meshes.clear();
+    EXPECT_EQ(Mesh::destructed, 0);
+    lua_gc(L, LUA_GCCOLLECT);
+    EXPECT_EQ(Mesh::destructed, 1);
+}
+
+TEST_F(RefCountedTest, Destruction) {
+    auto mesh = luabind::make_ref<Mesh>(3);
+    luabind::value_mirror<luabind::ref_ptr<Mesh>>::to_lua(L, mesh);
+    lua_setglobal(L, "mesh");
+    EXPECT_EQ(mesh->ref_count(), 2u);
+
+    // delete releases the reference of lua only
+    run("mesh:delete()");
+    EXPECT_EQ(mesh->ref_count(), 1u);
+    mesh.reset();
+    EXPECT_EQ(Mesh::destructed, 1);
+}
+
+TEST_F(RefCountedTest, UserDataSize) {
+    run("mesh = Mesh:create(1)");
+    lua_getglobal(L, "mesh");
+    // the reference count is in the object, user data has only the header
+    EXPECT_EQ(lua_rawlen(L, -1), sizeof(luabind::user_data));
+    lua_pop(L, 1);
+}
+
+TEST_F(RefCountedTest, Errors) {
+    Scene scene;
+    luabind::value_mirror<Scene*>::to_lua(L, &scene);
+    lua_setglobal(L, "scene");
+
+    // lua owned object can't be shared
+    runExpectingError("scene:add(Mesh:new(1))", testing::HasSubstr("is not a ref_ptr"));
+    EXPECT_TRUE(scene.meshes.empty());
+}
@@ -0,0 +1,114 @@
+#include "lua_test.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+struct Telemetry : luabind::Object {
+    std::vector<float> samples {1.5f, 2.5f, 3.5f};
+    std::vector<int> counters {1, 2, 3, 4};
+    std::vector<std::uint8_t> packet {0x10, 0x20, 0xff};
+
+    std::span<float> getSamples() {
+        return samples;
+    }
+
+    std::span<const int> getCounters() const {
+        return counters;
+    }
+
+    std::span<std::uint8_t> getPacket() {
+        return packet;
+    }
+
+    int sum(std::span<const int> values) const {
+        int r = 0;
+        for (int v : values) {
+            r += v;
+        }
+        return r;
+    }
+
+    void scale(std::span<float> values, float factor) {
+        for (float& v : values) {
+            v *= factor;
+        }
+    }
+};
+
+class SpanTest : public LuaTest {
+protected:
+    void SetUp() override {
+        const int top = lua_gettop(L);
+        luabind::class_<Telemetry>(L, "Telemetry")
+            .function("getSamples", &Telemetry::getSamples)
+            .function("getCounters", &Telemetry::getCounters)
+            .function("getPacket", &Telemetry::getPacket)
+            .function("sum", &Telemetry::sum)
+            .function("scale", &Telemetry::scale);
+        EXPECT_EQ(lua_gettop(L), top);
+
+        luabind::value_mirror<Telemetry*>::to_lua(L, &telemetry);
+        lua_setglobal(L, "telemetry");
+    }
+
+    Telemetry telemetry;
+};
+
+TEST_F(SpanTest, Access) {
+    int r = run(R"--(
+        local s = telemetry:getSamples()
+        assert(#s == 3)
+        assert(s[1] == 1.5 and s[3] == 3.5)
+        assert(s[0] == nil and s[4] == nil and s.x == nil)
+        s[2] = 4
+        telemetry:scale(s, 2)
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+    EXPECT_EQ(telemetry.samples, (std::vector<float> {3.f, 8.f, 7.f}));
+
+    // views of mutable memory can be passed as const
+    EXPECT_EQ(runWithResult<int>("return telemetry:sum(telemetry:getCounters())"), 10);
+}
+
+TEST_F(SpanTest, Bytes) {
+    int r = run(R"--(
+        local p = telemetry:getPacket()
+        assert(#p == 3)
+        assert(p[1] == 0x10 and p[3] == 0xff)
+        p[2] = 0x7f
+    )--");
+    EXPECT_EQ(r, LUA_OK);
+    EXPECT_EQ(telemetry.packet, (std::vector<std::uint8_t> {0x10, 0x7f, 0xff}));
+    runExpectingError("telemetry:sum(telemetry:getPacket())",
+                      testing::HasSubstr("Expecting span of 'int', but got 'userdata'"));
+    runExpectingError("telemetry:getPacket()[1] = 1.5", testing::HasSubstr("Expecting 'integer'"));
+}
+
+TEST_F(SpanTest, Errors) {
+    runExpectingError("telemetry:getSamples()[4] = 1", testing::HasSubstr("out of span range [1, 3]"));
+    runExpectingError("telemetry:getCounters()[1] = 1", testing::HasSubstr("read only"));
+    runExpectingError("telemetry:getSamples()[1] = 'x'", testing::HasSubstr("Expecting 'number'"));
+    runExpectingError("telemetry:sum(telemetry:getSamples())",
+                      testing::HasSubstr("Expecting span of 'int', but got 'userdata'"));
+    runExpectingError("telemetry:scale(telemetry:getCounters(), 2)", testing::HasSubstr("Expecting span of 'float'"));
+    runExpectingError("telemetry:sum({1, 2})", testing::HasSubstr("Expecting span"));
+    EXPECT_EQ(runWithResult<std::string>("return getmetatable(telemetry:getSamples())"), "span");
+}
+
+TEST_F(SpanTest, Lifetime) {
+    auto owner = std::make_shared<std::vector<double>>(5, 1.0);
+    std::weak_ptr<std::vector<double>> weak = owner;
+    luabind::span_user_data::to_lua(L, std::span<double>(*owner), owner);
+    lua_setglobal(L, "owned");
+    owner.reset();
+    EXPECT_EQ(runWithResult<int>("return #owned"), 5);
+    EXPECT_FALSE(weak.expired());
+
+    lua_getglobal(L, "owned");
+    luabind::span_user_data::invalidate(L, -1);
+    lua_pop(L, 1);
+    EXPECT_TRUE(weak.expired());
+    EXPECT_TRUE(runWithResult<bool>("return #owned == 0 and owned[1] == nil"));
+}
@@ -0,0 +1,58 @@
+#include "lua_test.hpp"
+
+// LUABIND_CHECK_LEVEL is 1 in this test, unless it is configured, see tests/CMakeLists.txt.
+constexpr bool checked = luabind::checked_call_v<false>;
+constexpr bool unchecked = !luabind::checked_call_v<true>;
+
+struct Point : luabind::Object {
+    Point() = default;
+    Point(int x)
+        : _x(x) {}
+
+    void set(int x) {
+        _x = x;
+    }
+
+    int _x = 0;
+};
+
+TEST_F(LuaTest, UncheckedFunctions) {
+    luabind::class_<Point>(L, "Point")
+        .function("set", &Point::set)
+        .function("setUnchecked", &Point::set, luabind::unchecked)
+        .function<&Point::set>("setStaticUnchecked", luabind::unchecked)
+        .class_function("createUnchecked", [](int x) { return Point {x}; }, luabind::unchecked);
+    luabind::function(L, "sum", [](int a, int b) { return a + b; });
+    luabind::function(L, "sumUnchecked", [](int a, int b) { return a + b; }, luabind::unchecked);
+
+    if constexpr (checked) {
+        runExpectingError("sum('2', 3)", testing::HasSubstr("Expecting 'integer', but got 'string'"));
+        runExpectingError("sum(2, 3, 4)", testing::HasSubstr("Invalid number of arguments"));
+        runExpectingError("Point:new():set('9')", testing::HasSubstr("Expecting 'integer', but got 'string'"));
+    }
+
+    if constexpr (unchecked) {
+        // raw conversions are used and extra arguments are ignored
+        EXPECT_EQ(runWithResult<int>("return sumUnchecked('2', 3, 4)"), 5);
+        EXPECT_EQ(runWithResult<Point>("return Point:createUnchecked('7')")._x, 7);
+        EXPECT_EQ(runWithResult<Point>(R"--(
+            local t = Point:new()
+            t:setUnchecked('9')
+            return t
+        )--")._x,
+                  9);
+        EXPECT_EQ(runWithResult<Point>(R"--(
+            local t = Point:new()
+            t:setStaticUnchecked('5')
+            return t
+        )--")._x,
+                  5);
+    } else {
+        runExpectingError("sumUnchecked('2', 3, 4)", testing::HasSubstr("Invalid number of arguments"));
+        runExpectingError("Point:new():setUnchecked('9')",
+                          testing::HasSubstr("Expecting 'integer', but got 'string'"));
+        runExpectingError("Point:new():setStaticUnchecked('5')",
+                          testing::HasSubstr("Expecting 'integer', but got 'string'"));
+    }
+    EXPECT_EQ(runWithResult<int>("return sumUnchecked(2, 3)"), 5);
+}
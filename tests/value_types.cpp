@@ -0,0 +1,160 @@
+#include "lua_test.hpp"
+
+#include <memory>
+#include <string>
+
+struct Vec3 final {
+    float x = 0;
+    float y = 0;
+    float z = 0;
+
+    Vec3() = default;
+    Vec3(float x, float y, float z)
+        : x(x)
+        , y(y)
+        , z(z) {}
+
+    float dot(const Vec3& other) const {
+        return x * other.x + y * other.y + z * other.z;
+    }
+};
+
+struct Label final {
+    std::string text;
+
+    Label(const std::string& t)
+        : text(t) {
+        ++alive;
+    }
+
+    Label(const Label& other)
+        : text(other.text) {
+        ++alive;
+    }
+
+    ~Label() {
+        --alive;
+    }
+
+    static int alive;
+};
+
+int Label::alive = 0;
+
+struct Node : luabind::Object {
+    int value = 0;
+};
+
+struct Unbound final {
+    int value = 0;
+};
+
+class ValueTypesTest : public LuaTest {
+protected:
+    void SetUp() override {
+        const int top = lua_gettop(L);
+        luabind::class_<Vec3>(L, "Vec3")
+            .constructor<float, float, float>("new")
+            .function("dot", &Vec3::dot)
+            .property("x", &Vec3::x)
+            .property("y", &Vec3::y)
+            .property("z", &Vec3::z);
+        luabind::class_<Label>(L, "Label").constructor<const std::string&>("new").construct_shared<const std::string&>(
+            "makeShared");
+        luabind::class_<Node>(L, "Node").property("value", &Node::value);
+        luabind::function(L, "length2", [](const Vec3& v) { return v.dot(v); });
+        luabind::function(L, "shift", [](Vec3* v, float d) { v->x += d; });
+
+        EXPECT_EQ(lua_gettop(L), top);
+    }
+};
+
+TEST_F(ValueTypesTest, Layout) {
+    static_assert(luabind::ValueType<Vec3>);
+    static_assert(!luabind::ValueType<Node>);
+    static_assert(sizeof(Vec3) == 3 * sizeof(float));
+
+    luabind::value_mirror<Vec3>::to_lua(L, Vec3 {1, 2, 3});
+    EXPECT_LT(lua_rawlen(L, -1), 3 * sizeof(void*) + sizeof(Vec3));
+    lua_pop(L, 1);
+}
+
+TEST_F(ValueTypesTest, Calls) {
+    EXPECT_EQ(runWithResult<float>(R"--(
+        local a = Vec3:new(1, 2, 3)
+        local b = Vec3:new(4, 5, 6)
+        return a:dot(b)
+    )--"),
+              32.f);
+
+    EXPECT_EQ(runWithResult<float>("return length2(Vec3:new(1, 2, 2))"), 9.f);
+
+    Vec3 v = runWithResult<Vec3>(R"--(
+        local v = Vec3:new(1, 2, 3)
+        v.y = 7
+        shift(v, 2)
+        return v
+    )--");
+    EXPECT_EQ(v.x, 3.f);
+    EXPECT_EQ(v.y, 7.f);
+    EXPECT_EQ(v.z, 3.f);
+
+    Vec3 cpp {1, 1, 1};
+    luabind::value_mirror<Vec3*>::to_lua(L, &cpp);
+    lua_setglobal(L, "cpp");
+    run("shift(cpp, 4)");
+    EXPECT_EQ(cpp.x, 5.f);
+}
+
+TEST_F(ValueTypesTest, Identity) {
+    runExpectingError("length2(Node:new())", testing::HasSubstr("Expecting 'Vec3' but got 'Node'"));
+    runExpectingError("Node.dot(Node:new(), Vec3:new(1, 2, 3))", testing::HasSubstr("attempt to call"));
+    runExpectingError("Vec3:new(1, 2, 3):dot(Node:new())", testing::HasSubstr("Expecting 'Vec3' but got 'Node'"));
+
+    EXPECT_TRUE(runWithResult<bool>("return Vec3:isInstance(Vec3:new(1, 2, 3))"));
+    EXPECT_FALSE(runWithResult<bool>("return Node:isInstance(Vec3:new(1, 2, 3))"));
+    EXPECT_FALSE(runWithResult<bool>("return Vec3:isInstance(Node:new())"));
+}
+
+TEST_F(ValueTypesTest, Destruction) {
+    run(R"--(
+        local a = Label:new("a")
+        local b = Label:makeShared("b")
+        c = Label:new("c")
+        c:delete()
+    )--");
+    lua_gc(L, LUA_GCCOLLECT);
+    EXPECT_EQ(Label::alive, 0);
+}
+
+TEST_F(ValueTypesTest, Unbound) {
+    Unbound u;
+    EXPECT_THROW(luabind::value_mirror<Unbound*>::to_lua(L, &u), luabind::error);
+}
+
+TEST_F(ValueTypesTest, Finalizers) {
+    auto hasFinalizer = [this](const char* name) {
+        lua_getglobal(L, name);
+        lua_getmetatable(L, -1);
+        const bool r = lua_getfield(L, -1, "__gc") != LUA_TNIL;
+        lua_pop(L, 3);
+        return r;
+    };
+    run("v = Vec3:new(1, 2, 3); l = Label:new('l')");
+    EXPECT_FALSE(hasFinalizer("v"));
+    EXPECT_TRUE(hasFinalizer("l"));
+
+    run("v:delete(); v = nil");
+    lua_gc(L, LUA_GCCOLLECT);
+
+    // shared objects need __gc to release the pointer
+    auto shared = std::make_shared<Vec3>(1.f, 2.f, 3.f);
+    std::weak_ptr<Vec3> weak = shared;
+    luabind::value_mirror<std::shared_ptr<Vec3>>::to_lua(L, std::move(shared));
+    lua_setglobal(L, "s");
+    EXPECT_TRUE(hasFinalizer("s"));
+    EXPECT_EQ(runWithResult<float>("return length2(s)"), 14.f);
+    run("s = nil");
+    lua_gc(L, LUA_GCCOLLECT);
+    EXPECT_TRUE(weak.expired());
+}